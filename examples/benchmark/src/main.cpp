@@ -0,0 +1,307 @@
+/**
+ * LEDEffect benchmark
+ * ===================
+ * Measures the render time of every effect for strip sizes from 30 to BENCH_MAX_LEDS LEDs,
+ * the time of FastLED's whole strip color operations against the ColorKernels ones and of the
+ * copy and brightness scale of a buffered output against the OutputStage lookup tables, the time
+ * to apply a JSON command and serialize the resulting state, the time to apply the same
+ * command as JSON and as binary and, on ESP32 and the host, the frame time of a serial
+ * render/output loop against a pipelined one.
+ *
+ * Effects render into a controller that never outputs anything so only the effect
+ * itself is measured. Results are printed on the serial port as CSV:
+ *
+ *   effect,leds,frames,ns_frame,ns_pixel
+ *   kernel,leds,ns_fastled,ns_kernel
+ *   command,iterations,ns_command,free_heap
+ *   protocol,iterations,ns_json,ns_binary
+ *   pipeline,leds,frames,us_frame
+ *
+ * Run it once on a known build, keep the output and compare it with the next build
+ * to catch regressions or to size a controller for a given strip.
+ */
+#include <Arduino.h>
+#include <FastLED.h>
+#include <LEDEffect.h>
+
+// Config
+#ifndef BENCH_MAX_LEDS
+#define BENCH_MAX_LEDS 1000
+#endif
+#ifndef BENCH_MIN_MICROS
+#define BENCH_MIN_MICROS 500000  // minimum measuring time per effect and size
+#endif
+#ifndef BENCH_MIN_FRAMES
+#define BENCH_MIN_FRAMES 20  // minimum number of frames per effect and size
+#endif
+#ifndef BENCH_COMMAND_ITERATIONS
+#define BENCH_COMMAND_ITERATIONS 1000  // iterations per JSON command
+#endif
+#ifndef BENCH_PIPELINE_LEDS
+#define BENCH_PIPELINE_LEDS 300  // leds of the pipeline benchmark
+#endif
+#ifndef BENCH_PIPELINE_FRAMES
+#define BENCH_PIPELINE_FRAMES 200  // frames of the pipeline benchmark
+#endif
+#define BENCH_WARMUP_FRAMES 10
+
+// Controller that does not output anything
+class BenchController : public CLEDController
+{
+public:
+  void init() override { }
+
+protected:
+  void showColor(const CRGB& /*data*/, int /*nLeds*/, CRGB /*scale*/) override { }
+  void show(const CRGB* /*data*/, int /*nLeds*/, CRGB /*scale*/) override { }
+};
+
+// Sink taking the time a WS2812 strip takes to receive the leds (30us per led) without outputting anything
+class WireSink : public OutputSink
+{
+public:
+  void show(const CRGB* /*leds*/, uint16_t size, uint8_t /*brightness*/) override {
+    delayMicroseconds(30 * size);
+  }
+};
+
+// Effects
+BaseEffect* effects[] = {
+  new RainbowEffect("rainbow"),
+  new SolidEffect("solid"),
+  new TwinkleEffect<BENCH_MAX_LEDS>("twinkle"),
+  new ApplauseEffect("applause"),
+  new JuggleEffect("juggle"),
+  new FireEffect<BENCH_MAX_LEDS>("fire"),
+  new PaletteEffect("palette", "rainbow")
+};
+const uint8_t effectCount = sizeof(effects) / sizeof(effects[0]);
+
+// Effects specialized on the strip length, only benchmarked with BENCH_FIXED_LEDS leds
+#define BENCH_FIXED_LEDS 300
+BaseEffect* fixedEffects[] = {
+  new TwinkleEffect<BENCH_FIXED_LEDS>("twinkle_fixed"),
+  new FireEffect<BENCH_FIXED_LEDS>("fire_fixed")
+};
+const uint8_t fixedEffectCount = sizeof(fixedEffects) / sizeof(fixedEffects[0]);
+LedEffect strip(effects, effectCount);
+
+// Strip sizes
+const uint16_t sizes[] = { 30, 90, 300, 1000, 3000, 10000 };
+const uint8_t sizeCount = sizeof(sizes) / sizeof(sizes[0]);
+
+// JSON commands
+const char* commands[] = {
+  "{\"state\": \"ON\", \"brightness\": 128}",
+  "{\"state\": \"ON\", \"effect\": {\"name\": \"solid\", \"color_rgb\": [255, 128, 0]}}",
+  "{\"effect\": {\"name\": \"twinkle\", \"palette\": \"ocean\", \"density\": 100, \"fade_rate\": 24}}"
+};
+const uint8_t commandCount = sizeof(commands) / sizeof(commands[0]);
+
+// Same commands in binary, effect 1 is solid and effect 2 is twinkle
+const uint8_t binaryCommand0[] = { 1, 1, 2, 128 };
+const uint8_t binaryCommand1[] = { 1, 1, 5, 1, 1, 255, 128, 0 };
+const uint8_t binaryCommand2[] = { 5, 2, 2, 5, 'o', 'c', 'e', 'a', 'n', 7, 100, 6, 24 };
+const uint8_t* binaryCommands[] = { binaryCommand0, binaryCommand1, binaryCommand2 };
+const size_t binaryCommandSizes[] = { sizeof(binaryCommand0), sizeof(binaryCommand1), sizeof(binaryCommand2) };
+
+BenchController controller;
+
+
+void benchmark(BaseEffect* effect, uint16_t size) {
+  effect->begin(&controller);
+  uint8_t* scratch = (uint8_t*)calloc(effect->scratchSize() + 1, 1);  // as lent by LedEffect
+  effect->activate(scratch);
+  const FrameContext frame(0, FrameContext::RATE_PERIOD, FrameContext::RATE_PERIOD);  // frames of the rates
+
+  // warmup
+  for (uint8_t i = 0; i < BENCH_WARMUP_FRAMES; i++) {
+    effect->loop(frame);
+  }
+
+  // measure
+  uint32_t frames = 0;
+  uint32_t elapsed = 0;
+  uint32_t startMicros = micros();
+  while (frames < BENCH_MIN_FRAMES || elapsed < BENCH_MIN_MICROS) {
+    effect->loop(frame);
+    frames++;
+    elapsed = micros() - startMicros;
+    yield();
+  }
+  free(scratch);
+
+  uint32_t nsFrame = (elapsed / frames) * 1000 + ((elapsed % frames) * 1000) / frames;
+  uint32_t nsPixel10 = nsFrame / size * 10 + (nsFrame % size) * 10 / size;  // one decimal
+  Serial.printf("%s,%u,%lu,%lu,%lu.%lu\n", effect->name, size, (unsigned long)frames, (unsigned long)nsFrame,
+    (unsigned long)(nsPixel10 / 10), (unsigned long)(nsPixel10 % 10));
+}
+
+// average time of count calls of operation in ns
+template<typename Operation>
+uint32_t measure(uint32_t count, Operation operation) {
+  uint32_t startMicros = micros();
+  for (uint32_t i = 0; i < count; i++) {
+    operation();
+    yield();
+  }
+  return (uint64_t)(micros() - startMicros) * 1000 / count;
+}
+
+void benchmarkKernels(CRGB* leds, CRGB* other, uint16_t size) {
+  const uint32_t count = max(BENCH_MIN_FRAMES, (int)(3000000UL / size) / 10);  // a few ms per operation
+  uint32_t fastled, kernel;
+
+  fastled = measure(count, [&]() { nscale8(leds, size, 200); });
+  kernel = measure(count, [&]() { ColorKernels::scale(leds, size, 200); });
+  Serial.printf("scale,%u,%lu,%lu\n", size, (unsigned long)fastled, (unsigned long)kernel);
+
+  fastled = measure(count, [&]() { fadeToBlackBy(leds, size, 32); });
+  kernel = measure(count, [&]() { ColorKernels::fade(leds, size, 32); });
+  Serial.printf("fade,%u,%lu,%lu\n", size, (unsigned long)fastled, (unsigned long)kernel);
+
+  fastled = measure(count, [&]() { for (uint16_t i = 0; i < size; i++) leds[i] += other[i]; });
+  kernel = measure(count, [&]() { ColorKernels::add(leds, other, size); });
+  Serial.printf("add,%u,%lu,%lu\n", size, (unsigned long)fastled, (unsigned long)kernel);
+
+  fastled = measure(count, [&]() { for (uint16_t i = 0; i < size; i++) nblend(leds[i], other[i], 100); });
+  kernel = measure(count, [&]() { ColorKernels::blend(leds, other, size, 100); });
+  Serial.printf("blend,%u,%lu,%lu\n", size, (unsigned long)fastled, (unsigned long)kernel);
+
+  static OutputStage stage;
+  stage.update(2.2f, 200, CRGB(255, 224, 192));
+  fastled = measure(count, [&]() { memcpy(other, leds, size * sizeof(CRGB)); ColorKernels::scale(other, size, 200); });
+  kernel = measure(count, [&]() { stage.apply(leds, other, size); });
+  Serial.printf("output,%u,%lu,%lu\n", size, (unsigned long)fastled, (unsigned long)kernel);
+}
+
+void benchmarkCommand(uint8_t index) {
+  const size_t size = 200;
+  char command[size] = "";
+  char state[size];
+
+  uint32_t startMicros = micros();
+  for (uint16_t i = 0; i < BENCH_COMMAND_ITERATIONS; i++) {
+    strncpy(command, commands[index], size - 1);  // deserialize modifies the command
+    strip.deserialize(command);
+    strip.printTo(state, size);
+    yield();
+  }
+  uint32_t elapsed = micros() - startMicros;
+
+  Serial.printf("%u,%u,%lu,%lu\n", index, BENCH_COMMAND_ITERATIONS,
+    (unsigned long)((uint64_t)elapsed * 1000 / BENCH_COMMAND_ITERATIONS), (unsigned long)ESP.getFreeHeap());
+}
+
+void benchmarkProtocol(uint8_t index) {
+  const size_t size = 200;
+  char command[size] = "";
+  uint32_t json, binary;
+
+  json = measure(BENCH_COMMAND_ITERATIONS, [&]() {
+    strncpy(command, commands[index], size - 1);  // deserialize modifies the command
+    strip.deserialize(command);
+  });
+  binary = measure(BENCH_COMMAND_ITERATIONS, [&]() {
+    strip.deserialize(binaryCommands[index], binaryCommandSizes[index]);
+  });
+
+  Serial.printf("%u,%u,%lu,%lu\n", index, BENCH_COMMAND_ITERATIONS, (unsigned long)json, (unsigned long)binary);
+}
+
+#ifdef LEDEFFECT_THREADED_SINK
+void benchmarkPipeline(const char* name, OutputSink* sink, bool pipelined) {
+  static CRGB leds[BENCH_PIPELINE_LEDS];
+  static CRGB front[BENCH_PIPELINE_LEDS];
+  static BaseEffect* pipelineEffects[] = { new FireEffect<BENCH_PIPELINE_LEDS>("fire") };
+  LedEffect pipelineStrip(pipelineEffects, 1);
+  pipelineStrip.blocking = false;
+  pipelineStrip.fps = 0;
+  pipelineStrip.begin(sink, leds, BENCH_PIPELINE_LEDS, pipelined ? front : 0);
+
+  uint32_t startMicros = micros();
+  for (uint16_t i = 0; i < BENCH_PIPELINE_FRAMES; i++) {
+    pipelineStrip.loop();
+  }
+  while (!sink->ready()) { }
+  uint32_t elapsed = micros() - startMicros;
+
+  Serial.printf("%s,%u,%u,%lu\n", name, BENCH_PIPELINE_LEDS, BENCH_PIPELINE_FRAMES,
+    (unsigned long)(elapsed / BENCH_PIPELINE_FRAMES));
+}
+#endif
+
+void setup() {
+  Serial.begin(115200);
+  delay(2000);
+
+  Serial.println(F("effect,leds,frames,ns_frame,ns_pixel"));
+  for (uint8_t s = 0; s < sizeCount; s++) {
+    if (sizes[s] > BENCH_MAX_LEDS)
+      break;
+
+    CRGB* leds = (CRGB*)malloc(sizes[s] * sizeof(CRGB));
+    if (!leds) {
+      Serial.printf("# not enough memory for %u leds\n", sizes[s]);
+      break;
+    }
+    fill_solid(leds, sizes[s], CRGB::Black);
+    controller.setLeds(leds, sizes[s]);
+
+    for (uint8_t e = 0; e < effectCount; e++) {
+      benchmark(effects[e], sizes[s]);
+    }
+    for (uint8_t e = 0; e < fixedEffectCount && sizes[s] == BENCH_FIXED_LEDS; e++) {
+      benchmark(fixedEffects[e], sizes[s]);
+    }
+
+    free(leds);
+  }
+
+  Serial.println(F("kernel,leds,ns_fastled,ns_kernel"));
+  for (uint8_t s = 0; s < sizeCount; s++) {
+    if (sizes[s] > BENCH_MAX_LEDS)
+      break;
+
+    CRGB* leds = (CRGB*)malloc(sizes[s] * sizeof(CRGB));
+    CRGB* other = (CRGB*)malloc(sizes[s] * sizeof(CRGB));
+    if (!leds || !other) {
+      Serial.printf("# not enough memory for %u leds\n", sizes[s]);
+      free(leds);
+      break;
+    }
+    for (uint16_t i = 0; i < sizes[s]; i++) {
+      leds[i] = CRGB(random8(), random8(), random8());
+      other[i] = CRGB(random8(), random8(), random8());
+    }
+
+    benchmarkKernels(leds, other, sizes[s]);
+
+    free(other);
+    free(leds);
+  }
+
+  Serial.println(F("command,iterations,ns_command,free_heap"));
+  strip.begin(&controller);
+  for (uint8_t c = 0; c < commandCount; c++) {
+    benchmarkCommand(c);
+  }
+
+  Serial.println(F("protocol,iterations,ns_json,ns_binary"));
+  for (uint8_t c = 0; c < commandCount; c++) {
+    benchmarkProtocol(c);
+  }
+
+#ifdef LEDEFFECT_THREADED_SINK
+  Serial.println(F("pipeline,leds,frames,us_frame"));
+  WireSink wireSink;
+  ThreadedSink threadedSink(&wireSink);
+  threadedSink.begin();
+  benchmarkPipeline("serial", &wireSink, false);
+  benchmarkPipeline("pipelined", &threadedSink, true);
+#endif
+  Serial.println(F("# done"));
+}
+
+void loop() {
+}
@@ -46,6 +46,7 @@
       {%- endif -%}
       {%- if transition is defined -%}
       , "brightness_rate": {{ transition * 4 }}
+      , "transition": {{ (transition * 1000) | int }}
       {%- endif -%}
       {%- if red is defined and green is defined and blue is defined -%}
       , "effect": {"name": "solid", "color_rgb": [{{ red }}, {{ green }}, {{ blue }}]}
@@ -109,12 +110,14 @@ const char* mqttTopicAvailability = "home/ledeffect/availability";  // CHANGEME
 const char* mqttTopicSet = "home/ledeffect/set";  // CHANGEME (or not)
 const char* mqttTopicTemperature = "home/ledeffect/temperature";  // CHANGEME (or not)
 const char* mqttTopicHumidity = "home/ledeffect/humidity";  // CHANGEME (or not)
+const char* mqttTopicStats = "home/ledeffect/stats";  // CHANGEME (or not)
 PubSubClient mqttClient("mqtt", 1883, wifiClient);  // CHANGEME
 
 // Data buffer
 const size_t dataSize = 800;
 char data[dataSize];
 size_t dataLength = 0;
+char command[dataSize];
 
 // DHT
 #ifdef DHT_PIN
@@ -125,17 +128,22 @@ unsigned int dhtReadings = 0;
 unsigned int dhtErrors = 0;
 #endif
 
+// Stats
+Ticker publishStatsTicker;
+volatile bool publishStats = false;
+
 // Strip
 CRGB leds[NUM_LEDS];
-BaseEffect* effects[] = {  // CHANGEME (you can add as many effects as you want with a unique name)
-  new RainbowEffect("rainbow"),
-  new SolidEffect("solid"),
-  new TwinkleEffect<NUM_LEDS>("twinkle"),
-  new ApplauseEffect("applause"),
-  new JuggleEffect("juggle")
+EffectFactory effects[] = {  // CHANGEME (you can add as many effects as you want with a unique name, only the selected one is in memory)
+  makeEffectFactory<RainbowEffect>("rainbow"),
+  makeEffectFactory<SolidEffect>("solid"),
+  makeEffectFactory<TwinkleEffect<NUM_LEDS>>("twinkle"),
+  makeEffectFactory<ApplauseEffect>("applause"),
+  makeEffectFactory<JuggleEffect>("juggle")
 };
 const uint8_t effectCount = 5;  // CHANGEME
-ColorStrip strip(effects, effectCount);
+EffectRegistry registry(effects, effectCount);
+LedEffect strip(registry);
 
 #ifdef DEBUG
  #ifndef DEBUG_PRINTER
@@ -284,7 +292,7 @@ void handleEffectsGet() {
   // create JSON
   JsonArray& root = jsonBuffer.createArray();
   for (size_t i = 0; i < effectCount; i++) {
-    root.add(effects[i]->name);
+    root.add(effects[i].name);
   }
 
   // send response
@@ -300,6 +308,13 @@ void handleLedsGet() {
   server.send(200, "application/json", response);
 }
 
+void handleStatsGet() {
+  // send response
+  String response;
+  strip.printStatsTo(response);
+  server.send(200, "application/json", response);
+}
+
 void handleLedsPost() {
   // check request
   if (!server.hasArg("plain")) {
@@ -308,36 +323,31 @@ void handleLedsPost() {
     return;
   }
 
-  // deserialize
-  server.arg("plain").toCharArray(data, dataSize);
-  if (!strip.deserialize(data)) {
+  // deserialize, at once to respond with the new state
+  server.arg("plain").toCharArray(command, dataSize);
+  if (!strip.deserialize(command)) {
     DEBUG_PRINTLN(F("REST: Deserialize failed"));
     server.send(400, "text/plain", "Could not parse the body");
     return;
   }
 
-  // serialize
-  dataLength = strip.printTo(data, dataSize);
-
-  // send the response to the client
-  server.send(201, "application/json", data);
+  // send the response to the client, the state is published by the strip's state callback
+  String response;
+  strip.printTo(response);
+  server.send(201, "application/json", response);
 }
 
 void mqttCallback(char* topic, byte* payload, unsigned int length) {
   // set
   if (strcmp(topic, mqttTopicSet) == 0) {
-    if (!strip.deserialize((char*)payload)) {
+    // queued to be applied with the other commands received before the next frame
+    length = min(length, (unsigned int)dataSize - 1);
+    memcpy(command, payload, length);
+    command[length] = '\0';
+    if (!strip.queue(command)) {
       DEBUG_PRINTLN(F("MQTT: Deserialize failed"));
       return;
     }
-
-    // serialize
-    dataLength = strip.printTo(data, dataSize);
-
-    DEBUG_PRINT(F("Strip: Data buffer "));
-    DEBUG_PRINT(dataLength);
-    DEBUG_PRINT(F("/"));
-    DEBUG_PRINTLN(dataSize);
   }
 }
 
@@ -395,7 +405,17 @@ void setup() {
   ArduinoOTA.begin();
 
   // Strip
+  strip.blocking = false;  // do not hold the server, MQTT and OTA while waiting for the next frame
   strip.begin(&FastLED.addLeds<NEOPIXEL, DATA_PIN>(leds, NUM_LEDS));  // CHANGEME
+  strip.stateCallback = [](LedEffect& strip) {
+    // serialize, published once per frame however many commands were applied
+    dataLength = strip.printTo(data, dataSize);
+
+    DEBUG_PRINT(F("Strip: Data buffer "));
+    DEBUG_PRINT(dataLength);
+    DEBUG_PRINT(F("/"));
+    DEBUG_PRINTLN(dataSize);
+  };
 
   // Server
 #ifdef DHT_PIN
@@ -405,6 +425,7 @@ void setup() {
   server.on("/effects", HTTP_GET, handleEffectsGet);
   server.on("/leds", HTTP_GET, handleLedsGet);
   server.on("/leds", HTTP_POST, handleLedsPost);
+  server.on("/stats", HTTP_GET, handleStatsGet);
   server.begin();
 
   // DHT
@@ -412,6 +433,9 @@ void setup() {
   dht.begin();
   publishDHTTicker.attach(60, [] () { publishDHT = true; });
 #endif
+
+  // Stats
+  publishStatsTicker.attach(60, [] () { publishStats = true; });
 }
 
 
@@ -464,6 +488,18 @@ void loop() {
     DEBUG_PRINTLN(F("MQTT: Published"));
   }
 
+  if (publishStats) {
+    // larger than MQTT_MAX_PACKET_SIZE, streamed
+    String payload;
+    strip.printStatsTo(payload);
+    mqttClient.beginPublish(mqttTopicStats, payload.length(), false);
+    mqttClient.print(payload);
+    mqttClient.endPublish();
+
+    DEBUG_PRINTLN(F("MQTT: Published"));
+    publishStats = false;
+  }
+
 #ifdef DHT_PIN
   if (publishDHT) {
     unsigned int size = 50;
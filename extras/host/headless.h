@@ -0,0 +1,65 @@
+#pragma once
+
+// Headless rendering of an effect configuration into a recording, for the renderer and the golden tests
+//
+// Time is frozen at the time of each frame and the random seed reset before the command, so that a configuration
+// renders the same frames on every run, as fast as the host allows.
+
+#include <LEDEffect.h>
+#include <string>
+#include <vector>
+
+#ifndef HEADLESS_MAX_LEDS
+#define HEADLESS_MAX_LEDS 1024
+#endif
+
+// Print into memory
+class MemoryPrint : public Print
+{
+public:
+  std::vector<uint8_t> data;
+
+  size_t write(uint8_t c) override {
+    data.push_back(c);
+    return 1;
+  }
+
+  size_t write(const uint8_t* buffer, size_t size) override {
+    data.insert(data.end(), buffer, buffer + size);
+    return size;
+  }
+
+  using Print::write;
+};
+
+// apply the JSON command json then record frames of size leds at fps to print, false if the command failed
+inline bool renderHeadless(Print& print, const char* json, uint32_t frames, uint16_t size, uint8_t fps) {
+  if (size == 0 || size > HEADLESS_MAX_LEDS || fps == 0)
+    return false;
+
+  RainbowEffect rainbow("rainbow");
+  SolidEffect solid("solid");
+  TwinkleEffect<HEADLESS_MAX_LEDS> twinkle("twinkle");
+  ApplauseEffect applause("applause");
+  JuggleEffect juggle("juggle");
+  FireEffect<HEADLESS_MAX_LEDS> fire("fire");
+  PaletteEffect palette("palette", "lava");
+  BaseEffect* effects[] = { &rainbow, &solid, &twinkle, &applause, &juggle, &fire, &palette };
+
+  std::vector<CRGB> leds(size, CRGB(CRGB::Black));
+  LedEffect strip(effects, sizeof(effects) / sizeof(effects[0]));
+  FrameRecorder recorder(print, fps);
+  hostFreezeTime(0);
+  random16_set_seed(1337);
+  strip.begin(&recorder, leds.data(), size);
+
+  std::string command(json);
+  bool success = strip.deserialize(&command[0]);
+  for (uint32_t i = 0; success && i < frames; i++) {
+    uint32_t now = (uint64_t)i * 1000000UL / fps;
+    hostFreezeTime(now);
+    strip.step(now);
+  }
+  hostReleaseTime();
+  return success;
+}
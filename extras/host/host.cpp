@@ -0,0 +1,280 @@
+// Definitions of the Arduino and FastLED stand-ins
+#include <Arduino.h>
+#include <FastLED.h>
+#include <stdarg.h>
+#include <chrono>
+#include <thread>
+
+HardwareSerial Serial;
+EspClass ESP;
+CFastLED FastLED;
+
+CLEDController* CLEDController::m_pHead = 0;
+CLEDController* CLEDController::m_pTail = 0;
+
+uint16_t rand16seed = 1337;
+
+const TProgmemRGBPalette16 CloudColors_p = {
+  CRGB::Blue, CRGB::DarkBlue, CRGB::DarkBlue, CRGB::DarkBlue,
+  CRGB::DarkBlue, CRGB::DarkBlue, CRGB::DarkBlue, CRGB::DarkBlue,
+  CRGB::Blue, CRGB::DarkBlue, CRGB::SkyBlue, CRGB::SkyBlue,
+  CRGB::LightBlue, CRGB::White, CRGB::LightBlue, CRGB::SkyBlue
+};
+
+const TProgmemRGBPalette16 LavaColors_p = {
+  CRGB::Black, CRGB::Maroon, CRGB::Black, CRGB::Maroon,
+  CRGB::DarkRed, CRGB::DarkRed, CRGB::Maroon, CRGB::DarkRed,
+  CRGB::DarkRed, CRGB::DarkRed, CRGB::Red, CRGB::Orange,
+  CRGB::White, CRGB::Orange, CRGB::Red, CRGB::DarkRed
+};
+
+const TProgmemRGBPalette16 OceanColors_p = {
+  CRGB::MidnightBlue, CRGB::DarkBlue, CRGB::MidnightBlue, CRGB::Navy,
+  CRGB::DarkBlue, CRGB::MediumBlue, CRGB::SeaGreen, CRGB::Teal,
+  CRGB::CadetBlue, CRGB::Blue, CRGB::DarkCyan, CRGB::CornflowerBlue,
+  CRGB::Aquamarine, CRGB::SeaGreen, CRGB::Aqua, CRGB::LightSkyBlue
+};
+
+const TProgmemRGBPalette16 ForestColors_p = {
+  CRGB::DarkGreen, CRGB::DarkGreen, CRGB::DarkOliveGreen, CRGB::DarkGreen,
+  CRGB::Green, CRGB::ForestGreen, CRGB::OliveDrab, CRGB::Green,
+  CRGB::SeaGreen, CRGB::MediumAquamarine, CRGB::LimeGreen, CRGB::YellowGreen,
+  CRGB::LightGreen, CRGB::LawnGreen, CRGB::MediumAquamarine, CRGB::ForestGreen
+};
+
+const TProgmemRGBPalette16 RainbowColors_p = {
+  0xFF0000, 0xD52A00, 0xAB5500, 0xAB7F00,
+  0xABAB00, 0x56D500, 0x00FF00, 0x00D52A,
+  0x00AB55, 0x0056AA, 0x0000FF, 0x2A00D5,
+  0x5500AB, 0x7F0081, 0xAB0055, 0xD5002B
+};
+
+const TProgmemRGBPalette16 RainbowStripeColors_p = {
+  0xFF0000, 0x000000, 0xAB5500, 0x000000,
+  0xABAB00, 0x000000, 0x00FF00, 0x000000,
+  0x00AB55, 0x000000, 0x0000FF, 0x000000,
+  0x5500AB, 0x000000, 0xAB0055, 0x000000
+};
+
+const TProgmemRGBPalette16 PartyColors_p = {
+  0x5500AB, 0x84007C, 0xB5004B, 0xE5001B,
+  0xE81700, 0xB84700, 0xAB7700, 0xABAB00,
+  0xAB5500, 0xDD2200, 0xF2000E, 0xC2003E,
+  0x8F0071, 0x5F00A1, 0x2F00D0, 0x0007F9
+};
+
+const TProgmemRGBPalette16 HeatColors_p = {
+  0x000000, 0x330000, 0x660000, 0x990000,
+  0xCC0000, 0xFF0000, 0xFF3300, 0xFF6600,
+  0xFF9900, 0xFFCC00, 0xFFFF00, 0xFFFF33,
+  0xFFFF66, 0xFFFF99, 0xFFFFCC, 0xFFFFFF
+};
+
+// FastLED's hsv2rgb_rainbow, C version
+void hsv2rgb_rainbow(const CHSV& hsv, CRGB& rgb) {
+  const uint8_t Y1 = 1;
+  const uint8_t Y2 = 0;
+  const uint8_t G2 = 0;
+  const uint8_t Gscale = 0;
+
+  uint8_t hue = hsv.hue;
+  uint8_t sat = hsv.sat;
+  uint8_t val = hsv.val;
+
+  uint8_t offset = hue & 0x1F;  // 0..31
+  uint8_t offset8 = offset << 3;
+  uint8_t third = scale8(offset8, (256 / 3));  // max = 85
+
+  uint8_t r, g, b;
+  if (!(hue & 0x80)) {
+    if (!(hue & 0x40)) {
+      if (!(hue & 0x20)) {
+        // case 0: R -> O
+        r = 255 - third;
+        g = third;
+        b = 0;
+      } else {
+        // case 1: O -> Y
+        if (Y1) {
+          r = 171;
+          g = 85 + third;
+          b = 0;
+        }
+        if (Y2) {
+          r = 170 + third;
+          uint8_t twothirds = scale8(offset8, ((256 * 2) / 3));  // max=170
+          g = 85 + twothirds;
+          b = 0;
+        }
+      }
+    } else {
+      // 01X
+      if (!(hue & 0x20)) {
+        // case 2: Y -> G
+        if (Y1) {
+          uint8_t twothirds = scale8(offset8, ((256 * 2) / 3));  // max=170
+          r = 171 - twothirds;
+          g = 170 + third;
+          b = 0;
+        }
+        if (Y2) {
+          r = 255 - offset8;
+          g = 255;
+          b = 0;
+        }
+      } else {
+        // case 3: G -> A
+        r = 0;
+        g = 255 - third;
+        b = third;
+      }
+    }
+  } else {
+    // section 1X
+    if (!(hue & 0x40)) {
+      if (!(hue & 0x20)) {
+        // case 4: A -> B
+        r = 0;
+        uint8_t twothirds = scale8(offset8, ((256 * 2) / 3));  // max=170
+        g = 171 - twothirds;
+        b = 85 + twothirds;
+      } else {
+        // case 5: B -> P
+        r = third;
+        g = 0;
+        b = 255 - third;
+      }
+    } else {
+      if (!(hue & 0x20)) {
+        // case 6: P -- K
+        r = 85 + third;
+        g = 0;
+        b = 171 - third;
+      } else {
+        // case 7: K -> R
+        r = 170 + third;
+        g = 0;
+        b = 85 - third;
+      }
+    }
+  }
+
+  // This is one of the good places to scale the green down, although the client can scale green down as well.
+  if (G2)
+    g = g >> 1;
+  if (Gscale)
+    g = scale8_video(g, Gscale);
+
+  // Scale down colors if we're desaturated at all and add the brightness_floor to r, g, and b.
+  if (sat != 255) {
+    if (sat == 0) {
+      r = 255;
+      b = 255;
+      g = 255;
+    } else {
+      uint8_t desat = 255 - sat;
+      desat = scale8_video(desat, desat);
+      uint8_t satscale = 255 - desat;
+#if FASTLED_SCALE8_FIXED == 1
+      if (r) r = scale8(r, satscale);
+      if (g) g = scale8(g, satscale);
+      if (b) b = scale8(b, satscale);
+#else
+      if (r) r = scale8(r, satscale) + 1;
+      if (g) g = scale8(g, satscale) + 1;
+      if (b) b = scale8(b, satscale) + 1;
+#endif
+      uint8_t brightness_floor = desat;
+      r += brightness_floor;
+      g += brightness_floor;
+      b += brightness_floor;
+    }
+  }
+
+  // Now scale everything down if we're at value < 255.
+  if (val != 255) {
+    val = scale8_video(val, val);
+    if (val == 0) {
+      r = 0;
+      g = 0;
+      b = 0;
+    } else {
+#if FASTLED_SCALE8_FIXED == 1
+      if (r) r = scale8(r, val);
+      if (g) g = scale8(g, val);
+      if (b) b = scale8(b, val);
+#else
+      if (r) r = scale8(r, val) + 1;
+      if (g) g = scale8(g, val) + 1;
+      if (b) b = scale8(b, val) + 1;
+#endif
+    }
+  }
+
+  rgb.r = r;
+  rgb.g = g;
+  rgb.b = b;
+}
+
+size_t Print::printf(const char* format, ...) {
+  char buffer[256];
+  va_list arguments;
+  va_start(arguments, format);
+  int length = vsnprintf(buffer, sizeof(buffer), format, arguments);
+  va_end(arguments);
+  if (length < 0)
+    return 0;
+  if ((size_t)length < sizeof(buffer))
+    return write((const uint8_t*)buffer, length);
+
+  std::string string(length + 1, '\0');
+  va_start(arguments, format);
+  vsnprintf(&string[0], string.size(), format, arguments);
+  va_end(arguments);
+  return write((const uint8_t*)string.data(), length);
+}
+
+// Time
+
+static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+static bool frozen = false;
+static uint32_t frozenMicros = 0;
+
+uint32_t micros() {
+  if (frozen)
+    return frozenMicros;
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+uint32_t millis() {
+  return micros() / 1000;
+}
+
+void delayMicroseconds(uint32_t us) {
+  if (frozen)
+    frozenMicros += us;
+  else
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void delay(uint32_t ms) {
+  delayMicroseconds(ms * 1000);
+}
+
+void yield() {
+  if (!frozen)
+    std::this_thread::yield();
+}
+
+void hostFreezeTime(uint32_t micros) {
+  frozen = true;
+  frozenMicros = micros;
+}
+
+void hostAdvanceTime(uint32_t micros) {
+  frozenMicros += micros;
+}
+
+void hostReleaseTime() {
+  frozen = false;
+}
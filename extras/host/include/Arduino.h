@@ -0,0 +1,178 @@
+#pragma once
+
+// Stand-in for the parts of the Arduino core used by LEDEffect, to build and test it on a host
+//
+// Time is real unless frozen with hostFreezeTime(), after which it only moves with hostAdvanceTime() and the
+// delays, so that tests and the headless renderer animate the same way on every run.
+
+#include <algorithm>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#define ARDUINO 10805
+#define ARDUINO_ARCH_HOST
+
+#define PROGMEM
+#define F(string) (string)
+#define bit(b) (1UL << (b))
+
+#define DEC 10
+#define HEX 16
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+using std::max;
+using std::min;
+
+uint32_t micros();
+uint32_t millis();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void hostFreezeTime(uint32_t micros);
+void hostAdvanceTime(uint32_t micros);
+void hostReleaseTime();
+
+class String : public std::string
+{
+public:
+  String() { };
+  String(const char* string) : std::string(string ? string : "") { };
+  String(const std::string& string) : std::string(string) { };
+  String(int value) : std::string(std::to_string(value)) { };
+  String(unsigned int value) : std::string(std::to_string(value)) { };
+  String(long value) : std::string(std::to_string(value)) { };
+  String(unsigned long value) : std::string(std::to_string(value)) { };
+
+  bool reserve(size_t size) {
+    std::string::reserve(size);
+    return true;
+  }
+
+  bool concat(char c) {
+    push_back(c);
+    return true;
+  }
+
+  bool concat(const char* string) {
+    append(string);
+    return true;
+  }
+
+  void toCharArray(char* buffer, size_t size) const {
+    if (size == 0)
+      return;
+    size_t length = std::min(this->size(), size - 1);
+    memcpy(buffer, data(), length);
+    buffer[length] = '\0';
+  }
+};
+
+class Print
+{
+public:
+  virtual ~Print() { };
+
+  virtual size_t write(uint8_t c) = 0;
+
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--)
+      n += write(*buffer++);
+    return n;
+  }
+
+  size_t write(const char* string) {
+    return string ? write((const uint8_t*)string, strlen(string)) : 0;
+  }
+
+  size_t write(const char* buffer, size_t size) {
+    return write((const uint8_t*)buffer, size);
+  }
+
+  size_t print(const char* string) { return write(string); }
+  size_t print(const String& string) { return write(string.c_str(), string.size()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned char value, int base = DEC) { return print((unsigned long)value, base); }
+  size_t print(int value, int base = DEC) { return print((long)value, base); }
+  size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+
+  size_t print(long value, int base = DEC) {
+    char buffer[24];
+    snprintf(buffer, sizeof(buffer), base == HEX ? "%lX" : "%ld", value);
+    return write(buffer);
+  }
+
+  size_t print(unsigned long value, int base = DEC) {
+    char buffer[24];
+    snprintf(buffer, sizeof(buffer), base == HEX ? "%lX" : "%lu", value);
+    return write(buffer);
+  }
+
+  size_t print(double value, int digits = 2) {
+    char buffer[48];
+    snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+    return write(buffer);
+  }
+
+  template<typename T>
+  size_t println(const T& value) {
+    size_t n = print(value);
+    return n + println();
+  }
+
+  size_t println() {
+    return write("\r\n");
+  }
+
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print
+{
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+};
+
+// stdout
+class HardwareSerial : public Stream
+{
+public:
+  void begin(unsigned long) { }
+
+  size_t write(uint8_t c) override {
+    return fputc(c, stdout) == EOF ? 0 : 1;
+  }
+
+  size_t write(const uint8_t* buffer, size_t size) override {
+    return fwrite(buffer, 1, size, stdout);
+  }
+
+  using Print::write;
+
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+};
+
+extern HardwareSerial Serial;
+
+// ESP8266/ESP32 system information, there is no heap limit on the host
+class EspClass
+{
+public:
+  uint32_t getFreeHeap() { return 0; }
+  void restart() { exit(0); }
+};
+
+extern EspClass ESP;
+
+#include "IPAddress.h"
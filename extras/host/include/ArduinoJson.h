@@ -0,0 +1,1164 @@
+#pragma once
+
+// Stand-in for the parts of ArduinoJson 5.13 used by LEDEffect, to build and test it on a host
+//
+// It behaves as ArduinoJson 5 where LEDEffect depends on it: objects and arrays are lists of nodes allocated in the
+// JsonBuffer, sized by JSON_OBJECT_SIZE() and JSON_ARRAY_SIZE(), a StaticJsonBuffer fails to allocate past its
+// capacity, parseObject(char*) parses in place, unquoted values are kept as raw strings converted by as<T>(), and
+// printTo() writes the same JSON.
+
+#include <Arduino.h>
+#include <new>
+#include <type_traits>
+
+namespace ArduinoJson {
+
+class JsonArray;
+class JsonObject;
+class JsonVariant;
+
+namespace Internals {
+
+template<typename T>
+struct ListNode
+{
+  ListNode* next = 0;
+  T content;
+};
+
+template<typename T, typename Enable = void>
+struct VariantAs;
+
+}  // namespace Internals
+
+class JsonBuffer
+{
+public:
+  virtual ~JsonBuffer() { };
+
+  virtual void* alloc(size_t bytes) = 0;
+
+  JsonArray& createArray();
+  JsonObject& createObject();
+
+  // parse in place, strings are unescaped and terminated in json which must outlive the result
+  JsonObject& parseObject(char* json, uint8_t nestingLimit = 10);
+  JsonArray& parseArray(char* json, uint8_t nestingLimit = 10);
+
+  // parse a copy of json
+  JsonObject& parseObject(const char* json, uint8_t nestingLimit = 10) {
+    return parseObject(strdup(json), nestingLimit);
+  }
+
+  JsonObject& parseObject(const String& json, uint8_t nestingLimit = 10) {
+    return parseObject(json.c_str(), nestingLimit);
+  }
+
+  JsonArray& parseArray(const char* json, uint8_t nestingLimit = 10) {
+    return parseArray(strdup(json), nestingLimit);
+  }
+
+  char* strdup(const char* string) {
+    if (!string)
+      return 0;
+    size_t size = strlen(string) + 1;
+    char* copy = (char*)alloc(size);
+    if (copy)
+      memcpy(copy, string, size);
+    return copy;
+  }
+
+protected:
+  static size_t round_size_up(size_t bytes) {
+    const size_t x = sizeof(void*) - 1;
+    return (bytes + x) & ~x;
+  }
+};
+
+class JsonVariant
+{
+public:
+  enum Type { UNDEFINED, UNPARSED, STRING, INTEGER, FLOAT, BOOLEAN, ARRAY, OBJECT };
+
+  JsonVariant() : _type(UNDEFINED) { _content.asInteger = 0; };
+
+  JsonVariant(bool value) : _type(BOOLEAN) { _content.asInteger = value; };
+
+  template<typename T>
+  JsonVariant(T value, typename std::enable_if<std::is_integral<T>::value>::type* = 0) : _type(INTEGER) {
+    _content.asInteger = value;
+  };
+
+  template<typename T>
+  JsonVariant(T value, typename std::enable_if<std::is_floating_point<T>::value>::type* = 0) : _type(FLOAT) {
+    _content.asFloat = value;
+  };
+
+  JsonVariant(const char* value) : _type(STRING) { _content.asString = value; };
+
+  JsonVariant(JsonArray& array);
+  JsonVariant(JsonObject& object);
+
+  static JsonVariant raw(const char* value) {
+    JsonVariant variant(value);
+    variant._type = UNPARSED;
+    return variant;
+  }
+
+  template<typename T>
+  T as() const {
+    return Internals::VariantAs<T>::get(*this);
+  }
+
+  template<typename T>
+  operator T() const {
+    return as<T>();
+  }
+
+  operator JsonArray&() const;
+  operator JsonObject&() const;
+
+  template<typename T>
+  typename std::enable_if<std::is_integral<T>::value, const JsonVariant>::type operator[](T index) const;
+  const JsonVariant operator[](const char* key) const;
+
+  bool success() const {
+    return _type != UNDEFINED;
+  }
+
+  Type type() const {
+    return _type;
+  }
+
+  size_t printTo(Print& print) const;
+
+  template<typename T>
+  T asInteger() const {
+    switch (_type) {
+      case UNDEFINED:
+      case ARRAY:
+      case OBJECT:
+        return 0;
+      case INTEGER:
+      case BOOLEAN:
+        return T(_content.asInteger);
+      case STRING:
+      case UNPARSED:
+        return parseInteger<T>(_content.asString);
+      default:
+        return T(_content.asFloat);
+    }
+  }
+
+  double asFloat() const {
+    switch (_type) {
+      case INTEGER:
+      case BOOLEAN:
+        return _content.asInteger;
+      case FLOAT:
+        return _content.asFloat;
+      case STRING:
+      case UNPARSED:
+        return _content.asString ? strtod(_content.asString, 0) : 0;
+      default:
+        return 0;
+    }
+  }
+
+  const char* asString() const {
+    if (_type == UNPARSED && _content.asString && strcmp("null", _content.asString) == 0)
+      return 0;
+    if (_type == STRING || _type == UNPARSED)
+      return _content.asString;
+    return 0;
+  }
+
+  JsonArray* asArray() const {
+    return _type == ARRAY ? _content.asArray : 0;
+  }
+
+  JsonObject* asObject() const {
+    return _type == OBJECT ? _content.asObject : 0;
+  }
+
+private:
+  Type _type;
+  union {
+    long asInteger;
+    double asFloat;
+    const char* asString;
+    JsonArray* asArray;
+    JsonObject* asObject;
+  } _content;
+
+  template<typename T>
+  static T parseInteger(const char* s) {
+    if (!s)
+      return 0;
+    if (*s == 't')
+      return 1;  // "true"
+    T result = 0;
+    bool negative = false;
+    if (*s == '-') {
+      negative = true;
+      s++;
+    } else if (*s == '+') {
+      s++;
+    }
+    while (*s >= '0' && *s <= '9') {
+      result = T(result * 10 + T(*s - '0'));
+      s++;
+    }
+    return negative ? T(~result + 1) : result;
+  }
+};
+
+struct JsonPair
+{
+  const char* key;
+  JsonVariant value;
+};
+
+namespace Internals {
+
+// write JSON as ArduinoJson 5 does
+class JsonPrinter
+{
+public:
+  JsonPrinter(Print& print) : _print(print) { };
+
+  void string(const char* value) {
+    if (!value) {
+      raw("null");
+      return;
+    }
+    write('"');
+    for (const char* c = value; *c; c++) {
+      switch (*c) {
+        case '"': raw("\\\""); break;
+        case '\\': raw("\\\\"); break;
+        case '\b': raw("\\b"); break;
+        case '\f': raw("\\f"); break;
+        case '\n': raw("\\n"); break;
+        case '\r': raw("\\r"); break;
+        case '\t': raw("\\t"); break;
+        default: write(*c);
+      }
+    }
+    write('"');
+  }
+
+  void raw(const char* value) {
+    _size += _print.write(value);
+  }
+
+  void write(char c) {
+    _size += _print.write((uint8_t)c);
+  }
+
+  size_t size() const {
+    return _size;
+  }
+
+private:
+  Print& _print;
+  size_t _size = 0;
+};
+
+// count the characters instead of writing them
+class NullPrint : public Print
+{
+public:
+  size_t write(uint8_t) override { return 1; }
+  size_t write(const uint8_t*, size_t size) override { return size; }
+  using Print::write;
+};
+
+class BufferPrint : public Print
+{
+public:
+  BufferPrint(char* buffer, size_t size) : _buffer(buffer), _size(size) {
+    if (_size)
+      _buffer[0] = 0;
+  };
+
+  size_t write(uint8_t c) override {
+    if (_length + 1 >= _size)
+      return 0;
+    _buffer[_length++] = c;
+    _buffer[_length] = 0;
+    return 1;
+  }
+
+  using Print::write;
+
+private:
+  char* _buffer;
+  size_t _size;
+  size_t _length = 0;
+};
+
+class StringPrint : public Print
+{
+public:
+  StringPrint(String& string) : _string(string) { };
+
+  size_t write(uint8_t c) override {
+    _string += (char)c;
+    return 1;
+  }
+
+  using Print::write;
+
+private:
+  String& _string;
+};
+
+// printTo() overloads of JsonArray and JsonObject, from a printTo(Print&)
+template<typename T>
+class JsonPrintable
+{
+public:
+  size_t printTo(char* buffer, size_t size) const {
+    BufferPrint print(buffer, size);
+    return static_cast<const T*>(this)->printTo(print);
+  }
+
+  template<size_t N>
+  size_t printTo(char (&buffer)[N]) const {
+    return printTo(buffer, N);
+  }
+
+  size_t printTo(String& string) const {
+    StringPrint print(string);
+    return static_cast<const T*>(this)->printTo(print);
+  }
+
+  size_t measureLength() const {
+    NullPrint print;
+    return static_cast<const T*>(this)->printTo(print);
+  }
+};
+
+}  // namespace Internals
+
+class JsonArray : public Internals::JsonPrintable<JsonArray>
+{
+public:
+  typedef Internals::ListNode<JsonVariant> node_type;
+
+  explicit JsonArray(JsonBuffer* buffer) : _buffer(buffer) { };
+
+  JsonArray(const JsonArray&) = delete;
+  JsonArray& operator=(const JsonArray&) = delete;
+
+  static JsonArray& invalid() {
+    static JsonArray array(0);
+    return array;
+  }
+
+  bool success() const {
+    return _buffer != 0;
+  }
+
+  size_t size() const {
+    size_t size = 0;
+    for (node_type* node = _first; node; node = node->next)
+      size++;
+    return size;
+  }
+
+  const JsonVariant get(size_t index) const {
+    node_type* node = _first;
+    while (node && index--)
+      node = node->next;
+    return node ? node->content : JsonVariant();
+  }
+
+  const JsonVariant operator[](size_t index) const {
+    return get(index);
+  }
+
+  template<typename T>
+  bool add(const T& value) {
+    return add(JsonVariant(value));
+  }
+
+  bool add(char* value) {
+    const char* copy = _buffer ? _buffer->strdup(value) : 0;
+    return copy && add(JsonVariant(copy));
+  }
+
+  bool add(const String& value) {
+    const char* copy = _buffer ? _buffer->strdup(value.c_str()) : 0;
+    return copy && add(JsonVariant(copy));
+  }
+
+  bool add(const JsonVariant& value) {
+    node_type* node = addNode();
+    if (!node)
+      return false;
+    node->content = value;
+    return true;
+  }
+
+  JsonArray& createNestedArray();
+  JsonObject& createNestedObject();
+
+  size_t printTo(Print& print) const {
+    Internals::JsonPrinter printer(print);
+    size_t size = 0;
+    printer.write('[');
+    for (node_type* node = _first; node; node = node->next) {
+      if (node != _first)
+        printer.write(',');
+      size += node->content.printTo(print);
+    }
+    printer.write(']');
+    return size + printer.size();
+  }
+
+  using Internals::JsonPrintable<JsonArray>::printTo;
+
+  class iterator
+  {
+  public:
+    iterator(node_type* node) : _node(node) { };
+    JsonVariant& operator*() const { return _node->content; }
+    JsonVariant* operator->() const { return &_node->content; }
+    iterator& operator++() { _node = _node->next; return *this; }
+    bool operator!=(const iterator& other) const { return _node != other._node; }
+    bool operator==(const iterator& other) const { return _node == other._node; }
+
+  private:
+    node_type* _node;
+  };
+
+  iterator begin() const { return iterator(_first); }
+  iterator end() const { return iterator(0); }
+
+private:
+  JsonBuffer* _buffer;
+  node_type* _first = 0;
+
+  node_type* addNode() {
+    if (!_buffer)
+      return 0;
+    void* memory = _buffer->alloc(sizeof(node_type));
+    if (!memory)
+      return 0;
+    node_type* node = new (memory) node_type();
+    if (!_first) {
+      _first = node;
+    } else {
+      node_type* last = _first;
+      while (last->next)
+        last = last->next;
+      last->next = node;
+    }
+    return node;
+  }
+};
+
+class JsonObject;
+
+// the value of a key of an object, assigning it sets the key while reading it does not create it
+class JsonObjectSubscript
+{
+public:
+  JsonObjectSubscript(JsonObject& object, const char* key) : _object(object), _key(key) { };
+
+  template<typename T>
+  JsonObjectSubscript& operator=(const T& value);
+  JsonObjectSubscript& operator=(char* value);
+  JsonObjectSubscript& operator=(const JsonObjectSubscript& other);
+
+  const JsonVariant get() const;
+
+  template<typename T>
+  T as() const {
+    return get().template as<T>();
+  }
+
+  template<typename T>
+  operator T() const {
+    return get().template as<T>();
+  }
+
+  operator JsonArray&() const { return get(); }
+  operator JsonObject&() const { return get(); }
+
+  template<typename T>
+  const JsonVariant operator[](T key) const {
+    return get()[key];
+  }
+
+  bool success() const;
+
+  size_t printTo(Print& print) const {
+    return get().printTo(print);
+  }
+
+private:
+  JsonObject& _object;
+  const char* _key;
+};
+
+class JsonObject : public Internals::JsonPrintable<JsonObject>
+{
+public:
+  typedef Internals::ListNode<JsonPair> node_type;
+
+  explicit JsonObject(JsonBuffer* buffer) : _buffer(buffer) { };
+
+  JsonObject(const JsonObject&) = delete;
+  JsonObject& operator=(const JsonObject&) = delete;
+
+  static JsonObject& invalid() {
+    static JsonObject object(0);
+    return object;
+  }
+
+  bool success() const {
+    return _buffer != 0;
+  }
+
+  size_t size() const {
+    size_t size = 0;
+    for (node_type* node = _first; node; node = node->next)
+      size++;
+    return size;
+  }
+
+  bool containsKey(const char* key) const {
+    return find(key) != 0;
+  }
+
+  const JsonVariant get(const char* key) const {
+    node_type* node = find(key);
+    return node ? node->content.value : JsonVariant();
+  }
+
+  template<typename T>
+  T get(const char* key) const {
+    return get(key).template as<T>();
+  }
+
+  JsonObjectSubscript operator[](const char* key) {
+    return JsonObjectSubscript(*this, key);
+  }
+
+  const JsonVariant operator[](const char* key) const {
+    return get(key);
+  }
+
+  template<typename T>
+  bool set(const char* key, const T& value) {
+    return set(key, JsonVariant(value));
+  }
+
+  bool set(const char* key, char* value) {
+    const char* copy = _buffer ? _buffer->strdup(value) : 0;
+    return copy && set(key, JsonVariant(copy));
+  }
+
+  bool set(const char* key, const String& value) {
+    const char* copy = _buffer ? _buffer->strdup(value.c_str()) : 0;
+    return copy && set(key, JsonVariant(copy));
+  }
+
+  bool set(const char* key, const JsonVariant& value) {
+    node_type* node = find(key);
+    if (!node)
+      node = addNode(key);
+    if (!node)
+      return false;
+    node->content.value = value;
+    return true;
+  }
+
+  void remove(const char* key) {
+    node_type* previous = 0;
+    for (node_type* node = _first; node; previous = node, node = node->next) {
+      if (strcmp(node->content.key, key) == 0) {
+        if (previous)
+          previous->next = node->next;
+        else
+          _first = node->next;
+        return;
+      }
+    }
+  }
+
+  JsonArray& createNestedArray(const char* key);
+  JsonObject& createNestedObject(const char* key);
+
+  size_t printTo(Print& print) const {
+    Internals::JsonPrinter printer(print);
+    size_t size = 0;
+    printer.write('{');
+    for (node_type* node = _first; node; node = node->next) {
+      if (node != _first)
+        printer.write(',');
+      printer.string(node->content.key);
+      printer.write(':');
+      size += node->content.value.printTo(print);
+    }
+    printer.write('}');
+    return size + printer.size();
+  }
+
+  using Internals::JsonPrintable<JsonObject>::printTo;
+
+  class iterator
+  {
+  public:
+    iterator(node_type* node) : _node(node) { };
+    JsonPair& operator*() const { return _node->content; }
+    JsonPair* operator->() const { return &_node->content; }
+    iterator& operator++() { _node = _node->next; return *this; }
+    bool operator!=(const iterator& other) const { return _node != other._node; }
+    bool operator==(const iterator& other) const { return _node == other._node; }
+
+  private:
+    node_type* _node;
+  };
+
+  iterator begin() const { return iterator(_first); }
+  iterator end() const { return iterator(0); }
+
+private:
+  JsonBuffer* _buffer;
+  node_type* _first = 0;
+
+  node_type* find(const char* key) const {
+    for (node_type* node = _first; node; node = node->next) {
+      if (key && node->content.key && strcmp(node->content.key, key) == 0)
+        return node;
+    }
+    return 0;
+  }
+
+  node_type* addNode(const char* key) {
+    if (!_buffer)
+      return 0;
+    void* memory = _buffer->alloc(sizeof(node_type));
+    if (!memory)
+      return 0;
+    node_type* node = new (memory) node_type();
+    node->content.key = key;
+    if (!_first) {
+      _first = node;
+    } else {
+      node_type* last = _first;
+      while (last->next)
+        last = last->next;
+      last->next = node;
+    }
+    return node;
+  }
+};
+
+// JsonVariant
+
+inline JsonVariant::JsonVariant(JsonArray& array) : _type(array.success() ? ARRAY : UNDEFINED) {
+  _content.asArray = &array;
+}
+
+inline JsonVariant::JsonVariant(JsonObject& object) : _type(object.success() ? OBJECT : UNDEFINED) {
+  _content.asObject = &object;
+}
+
+inline JsonVariant::operator JsonArray&() const {
+  return _type == ARRAY ? *_content.asArray : JsonArray::invalid();
+}
+
+inline JsonVariant::operator JsonObject&() const {
+  return _type == OBJECT ? *_content.asObject : JsonObject::invalid();
+}
+
+template<typename T>
+inline typename std::enable_if<std::is_integral<T>::value, const JsonVariant>::type
+JsonVariant::operator[](T index) const {
+  return _type == ARRAY ? _content.asArray->get(index) : JsonVariant();
+}
+
+inline const JsonVariant JsonVariant::operator[](const char* key) const {
+  return _type == OBJECT ? _content.asObject->get(key) : JsonVariant();
+}
+
+inline size_t JsonVariant::printTo(Print& print) const {
+  Internals::JsonPrinter printer(print);
+  switch (_type) {
+    case STRING:
+      printer.string(_content.asString);
+      break;
+    case UNPARSED:
+      printer.raw(_content.asString);
+      break;
+    case INTEGER: {
+      char buffer[24];
+      snprintf(buffer, sizeof(buffer), "%ld", _content.asInteger);
+      printer.raw(buffer);
+      break;
+    }
+    case FLOAT: {
+      char buffer[32];
+      if (isnan(_content.asFloat))
+        snprintf(buffer, sizeof(buffer), "NaN");
+      else if (isinf(_content.asFloat))
+        snprintf(buffer, sizeof(buffer), _content.asFloat > 0 ? "Infinity" : "-Infinity");
+      else
+        snprintf(buffer, sizeof(buffer), "%.9g", _content.asFloat);
+      printer.raw(buffer);
+      break;
+    }
+    case BOOLEAN:
+      printer.raw(_content.asInteger ? "true" : "false");
+      break;
+    case ARRAY:
+      return _content.asArray->printTo(print);
+    case OBJECT:
+      return _content.asObject->printTo(print);
+    default:
+      break;
+  }
+  return printer.size();
+}
+
+namespace Internals {
+
+template<typename T>
+struct VariantAs<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type>
+{
+  static T get(const JsonVariant& variant) { return variant.asInteger<T>(); }
+};
+
+template<typename T>
+struct VariantAs<T, typename std::enable_if<std::is_enum<T>::value>::type>
+{
+  static T get(const JsonVariant& variant) { return T(variant.asInteger<int>()); }
+};
+
+template<>
+struct VariantAs<bool>
+{
+  static bool get(const JsonVariant& variant) { return variant.asInteger<int>() != 0; }
+};
+
+template<typename T>
+struct VariantAs<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+  static T get(const JsonVariant& variant) { return T(variant.asFloat()); }
+};
+
+template<>
+struct VariantAs<const char*>
+{
+  static const char* get(const JsonVariant& variant) { return variant.asString(); }
+};
+
+template<>
+struct VariantAs<String>
+{
+  static String get(const JsonVariant& variant) {
+    const char* string = variant.asString();
+    if (string)
+      return String(string);
+    String printed;
+    StringPrint print(printed);
+    variant.printTo(print);
+    return printed;
+  }
+};
+
+template<>
+struct VariantAs<JsonArray&>
+{
+  static JsonArray& get(const JsonVariant& variant) { return variant; }
+};
+
+template<>
+struct VariantAs<const JsonArray&>
+{
+  static const JsonArray& get(const JsonVariant& variant) { return variant.operator JsonArray&(); }
+};
+
+template<>
+struct VariantAs<JsonObject&>
+{
+  static JsonObject& get(const JsonVariant& variant) { return variant; }
+};
+
+template<>
+struct VariantAs<const JsonObject&>
+{
+  static const JsonObject& get(const JsonVariant& variant) { return variant.operator JsonObject&(); }
+};
+
+template<>
+struct VariantAs<JsonVariant>
+{
+  static JsonVariant get(const JsonVariant& variant) { return variant; }
+};
+
+// parse JSON in place as ArduinoJson 5 does, accepting single quotes and unquoted keys and values
+class JsonParser
+{
+public:
+  JsonParser(JsonBuffer* buffer, char* json, uint8_t nestingLimit)
+    : _buffer(buffer), _ptr(json), _nestingLimit(nestingLimit) { };
+
+  JsonArray& parseArray() {
+    if (!_ptr || !_nestingLimit)
+      return JsonArray::invalid();
+    _nestingLimit--;
+    skipSpaces();
+    if (*_ptr != '[')
+      return JsonArray::invalid();
+    _ptr++;
+    JsonArray& array = _buffer->createArray();
+    if (!array.success())
+      return JsonArray::invalid();
+    skipSpaces();
+    if (*_ptr == ']') {
+      _ptr++;
+      _nestingLimit++;
+      return array;
+    }
+    for (;;) {
+      JsonVariant value;
+      if (!parseValue(value) || !array.add(value))
+        return JsonArray::invalid();
+      skipSpaces();
+      if (*_ptr == ']') {
+        _ptr++;
+        _nestingLimit++;
+        return array;
+      }
+      if (*_ptr != ',')
+        return JsonArray::invalid();
+      _ptr++;
+    }
+  }
+
+  JsonObject& parseObject() {
+    if (!_ptr || !_nestingLimit)
+      return JsonObject::invalid();
+    _nestingLimit--;
+    skipSpaces();
+    if (*_ptr != '{')
+      return JsonObject::invalid();
+    _ptr++;
+    JsonObject& object = _buffer->createObject();
+    if (!object.success())
+      return JsonObject::invalid();
+    skipSpaces();
+    if (*_ptr == '}') {
+      _ptr++;
+      _nestingLimit++;
+      return object;
+    }
+    for (;;) {
+      skipSpaces();
+      const char* key = parseString();
+      if (!key)
+        return JsonObject::invalid();
+      skipSpaces();
+      if (*_ptr != ':')
+        return JsonObject::invalid();
+      _ptr++;
+      JsonVariant value;
+      if (!parseValue(value) || !object.set(key, value))
+        return JsonObject::invalid();
+      skipSpaces();
+      if (*_ptr == '}') {
+        _ptr++;
+        _nestingLimit++;
+        return object;
+      }
+      if (*_ptr != ',')
+        return JsonObject::invalid();
+      _ptr++;
+    }
+  }
+
+private:
+  JsonBuffer* _buffer;
+  char* _ptr;
+  uint8_t _nestingLimit;
+
+  void skipSpaces() {
+    while (*_ptr == ' ' || *_ptr == '\t' || *_ptr == '\r' || *_ptr == '\n')
+      _ptr++;
+  }
+
+  bool parseValue(JsonVariant& value) {
+    skipSpaces();
+    if (*_ptr == '[') {
+      JsonArray& array = parseArray();
+      value = array;
+      return array.success();
+    }
+    if (*_ptr == '{') {
+      JsonObject& object = parseObject();
+      value = object;
+      return object.success();
+    }
+    bool quoted = *_ptr == '"' || *_ptr == '\'';
+    const char* string = parseString();
+    if (!string)
+      return false;
+    value = quoted ? JsonVariant(string) : JsonVariant::raw(string);
+    return true;
+  }
+
+  static bool canBeInNonQuotedString(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '+' || c == '-' ||
+           c == '.' || c == '_';
+  }
+
+  // unescape the string where it is and terminate it, return 0 if there is none
+  const char* parseString() {
+    char quote = *_ptr;
+    if (quote == '"' || quote == '\'') {
+      char* string = ++_ptr;
+      char* end = string;
+      for (;;) {
+        char c = *_ptr++;
+        if (c == '\0')
+          return 0;
+        if (c == quote)
+          break;
+        if (c == '\\') {
+          c = *_ptr++;
+          switch (c) {
+            case 'b': c = '\b'; break;
+            case 'f': c = '\f'; break;
+            case 'n': c = '\n'; break;
+            case 'r': c = '\r'; break;
+            case 't': c = '\t'; break;
+            case '\0': return 0;
+            default: break;
+          }
+        }
+        *end++ = c;
+      }
+      *end = '\0';
+      return string;
+    }
+
+    // the character before an unquoted string is a separator already parsed, move the string over it so that
+    // it can be terminated without overwriting the next separator
+    char* start = _ptr;
+    while (canBeInNonQuotedString(*_ptr))
+      _ptr++;
+    if (_ptr == start)
+      return 0;
+    size_t length = _ptr - start;
+    memmove(start - 1, start, length);
+    start[length - 1] = '\0';
+    return start - 1;
+  }
+};
+
+}  // namespace Internals
+
+// JsonBuffer
+
+inline JsonArray& JsonBuffer::createArray() {
+  void* memory = alloc(sizeof(JsonArray));
+  return memory ? *new (memory) JsonArray(this) : JsonArray::invalid();
+}
+
+inline JsonObject& JsonBuffer::createObject() {
+  void* memory = alloc(sizeof(JsonObject));
+  return memory ? *new (memory) JsonObject(this) : JsonObject::invalid();
+}
+
+inline JsonObject& JsonBuffer::parseObject(char* json, uint8_t nestingLimit) {
+  Internals::JsonParser parser(this, json, nestingLimit);
+  return parser.parseObject();
+}
+
+inline JsonArray& JsonBuffer::parseArray(char* json, uint8_t nestingLimit) {
+  Internals::JsonParser parser(this, json, nestingLimit);
+  return parser.parseArray();
+}
+
+inline JsonArray& JsonArray::createNestedArray() {
+  if (!_buffer)
+    return JsonArray::invalid();
+  JsonArray& array = _buffer->createArray();
+  add(JsonVariant(array));
+  return array;
+}
+
+inline JsonObject& JsonArray::createNestedObject() {
+  if (!_buffer)
+    return JsonObject::invalid();
+  JsonObject& object = _buffer->createObject();
+  add(JsonVariant(object));
+  return object;
+}
+
+inline JsonArray& JsonObject::createNestedArray(const char* key) {
+  if (!_buffer)
+    return JsonArray::invalid();
+  JsonArray& array = _buffer->createArray();
+  set(key, JsonVariant(array));
+  return array;
+}
+
+inline JsonObject& JsonObject::createNestedObject(const char* key) {
+  if (!_buffer)
+    return JsonObject::invalid();
+  JsonObject& object = _buffer->createObject();
+  set(key, JsonVariant(object));
+  return object;
+}
+
+// JsonObjectSubscript
+
+template<typename T>
+inline JsonObjectSubscript& JsonObjectSubscript::operator=(const T& value) {
+  _object.set(_key, value);
+  return *this;
+}
+
+inline JsonObjectSubscript& JsonObjectSubscript::operator=(char* value) {
+  _object.set(_key, value);
+  return *this;
+}
+
+inline JsonObjectSubscript& JsonObjectSubscript::operator=(const JsonObjectSubscript& other) {
+  _object.set(_key, other.get());
+  return *this;
+}
+
+inline const JsonVariant JsonObjectSubscript::get() const {
+  return _object.get(_key);
+}
+
+inline bool JsonObjectSubscript::success() const {
+  return _object.containsKey(_key);
+}
+
+// Buffers
+
+namespace Internals {
+
+class StaticJsonBufferBase : public JsonBuffer
+{
+public:
+  StaticJsonBufferBase(char* buffer, size_t capacity) : _buffer(buffer), _capacity(capacity), _size(0) { };
+
+  StaticJsonBufferBase(const StaticJsonBufferBase&) = delete;
+  StaticJsonBufferBase& operator=(const StaticJsonBufferBase&) = delete;
+
+  size_t capacity() const {
+    return _capacity;
+  }
+
+  size_t size() const {
+    return _size;
+  }
+
+  void* alloc(size_t bytes) override {
+    size_t size = round_size_up(_size);
+    if (size + bytes > _capacity)
+      return 0;
+    _size = size + bytes;
+    return _buffer + size;
+  }
+
+protected:
+  void clear() {
+    _size = 0;
+  }
+
+private:
+  char* _buffer;
+  size_t _capacity;
+  size_t _size;
+};
+
+}  // namespace Internals
+
+template<size_t CAPACITY>
+class StaticJsonBuffer : public Internals::StaticJsonBufferBase
+{
+public:
+  StaticJsonBuffer() : Internals::StaticJsonBufferBase(_data, CAPACITY) { };
+
+private:
+  char _data[CAPACITY];
+};
+
+// blocks of at least initialSize bytes, the next block twice as large as the previous one
+class DynamicJsonBuffer : public JsonBuffer
+{
+public:
+  explicit DynamicJsonBuffer(size_t initialSize = 256) : _nextBlockCapacity(initialSize) { };
+
+  DynamicJsonBuffer(const DynamicJsonBuffer&) = delete;
+  DynamicJsonBuffer& operator=(const DynamicJsonBuffer&) = delete;
+
+  ~DynamicJsonBuffer() {
+    clear();
+  }
+
+  size_t size() const {
+    size_t size = 0;
+    for (Block* block = _head; block; block = block->next)
+      size += block->size;
+    return size;
+  }
+
+  void* alloc(size_t bytes) override {
+    bytes = round_size_up(bytes);
+    if (!_head || _head->size + bytes > _head->capacity) {
+      size_t capacity = _nextBlockCapacity > bytes ? _nextBlockCapacity : bytes;
+      Block* block = (Block*)malloc(sizeof(Block) + capacity);
+      if (!block)
+        return 0;
+      block->next = _head;
+      block->capacity = capacity;
+      block->size = 0;
+      _head = block;
+      _nextBlockCapacity = capacity * 2;
+    }
+    void* memory = (char*)(_head + 1) + _head->size;
+    _head->size += bytes;
+    return memory;
+  }
+
+  void clear() {
+    while (_head) {
+      Block* next = _head->next;
+      free(_head);
+      _head = next;
+    }
+  }
+
+private:
+  struct Block
+  {
+    Block* next;
+    size_t capacity;
+    size_t size;
+  };
+
+  Block* _head = 0;
+  size_t _nextBlockCapacity;
+};
+
+}  // namespace ArduinoJson
+
+using namespace ArduinoJson;
+
+#define JSON_ARRAY_SIZE(NUMBER_OF_ELEMENTS) \
+  (sizeof(ArduinoJson::JsonArray) + (NUMBER_OF_ELEMENTS) * sizeof(ArduinoJson::JsonArray::node_type))
+
+#define JSON_OBJECT_SIZE(NUMBER_OF_ELEMENTS) \
+  (sizeof(ArduinoJson::JsonObject) + (NUMBER_OF_ELEMENTS) * sizeof(ArduinoJson::JsonObject::node_type))
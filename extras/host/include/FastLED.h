@@ -0,0 +1,612 @@
+#pragma once
+
+// Stand-in for the parts of FastLED 3.3 used by LEDEffect, to build and test it on a host
+//
+// The color math is FastLED's C implementation, with FASTLED_SCALE8_FIXED and FASTLED_BLEND_FIXED as in FastLED
+// 3.2+ by default, so that frames rendered on the host are the ones a device renders. Controllers output nothing,
+// tests derive from CLEDController to look at what is shown.
+
+#include <Arduino.h>
+
+#define FASTLED_VERSION 3003002
+
+#ifndef FASTLED_SCALE8_FIXED
+#define FASTLED_SCALE8_FIXED 1
+#endif
+
+#ifndef FASTLED_BLEND_FIXED
+#define FASTLED_BLEND_FIXED 1
+#endif
+
+typedef uint8_t fract8;
+typedef uint16_t fract16;
+typedef uint16_t accum88;
+
+// lib8tion
+
+inline uint8_t scale8(uint8_t i, fract8 scale) {
+#if FASTLED_SCALE8_FIXED == 1
+  return ((uint16_t)i * (1 + (uint16_t)scale)) >> 8;
+#else
+  return ((uint16_t)i * (uint16_t)scale) >> 8;
+#endif
+}
+
+inline uint8_t scale8_video(uint8_t i, fract8 scale) {
+  return (((uint16_t)i * (uint16_t)scale) >> 8) + ((i && scale) ? 1 : 0);
+}
+
+inline uint16_t scale16(uint16_t i, fract16 scale) {
+#if FASTLED_SCALE8_FIXED == 1
+  return ((uint32_t)i * (1 + (uint32_t)scale)) >> 16;
+#else
+  return ((uint32_t)i * (uint32_t)scale) >> 16;
+#endif
+}
+
+inline uint8_t qadd8(uint8_t i, uint8_t j) {
+  unsigned int t = i + j;
+  return t > 255 ? 255 : t;
+}
+
+inline uint8_t qsub8(uint8_t i, uint8_t j) {
+  int t = i - j;
+  return t < 0 ? 0 : t;
+}
+
+inline uint8_t blend8(uint8_t a, uint8_t b, uint8_t amountOfB) {
+  uint16_t partial;
+#if FASTLED_BLEND_FIXED == 1
+  partial = (a << 8) | b;
+  partial += b * amountOfB;
+  partial -= a * amountOfB;
+#else
+  uint8_t amountOfA = 255 - amountOfB;
+  partial = a * amountOfA;
+#if FASTLED_SCALE8_FIXED == 1
+  partial += a;
+#endif
+  partial += b * amountOfB;
+#if FASTLED_SCALE8_FIXED == 1
+  partial += b;
+#endif
+#endif
+  return partial >> 8;
+}
+
+extern uint16_t rand16seed;
+
+inline uint8_t random8() {
+  rand16seed = (rand16seed * 2053) + 13849;
+  return (uint8_t)(rand16seed & 0xFF) + (uint8_t)(rand16seed >> 8);
+}
+
+inline uint8_t random8(uint8_t lim) {
+  return (random8() * lim) >> 8;
+}
+
+inline uint8_t random8(uint8_t min, uint8_t lim) {
+  return random8(lim - min) + min;
+}
+
+inline uint16_t random16() {
+  rand16seed = (rand16seed * 2053) + 13849;
+  return rand16seed;
+}
+
+inline uint16_t random16(uint16_t lim) {
+  return ((uint32_t)lim * random16()) >> 16;
+}
+
+inline uint16_t random16(uint16_t min, uint16_t lim) {
+  return random16(lim - min) + min;
+}
+
+inline uint16_t random16_get_seed() { return rand16seed; }
+inline void random16_set_seed(uint16_t seed) { rand16seed = seed; }
+inline void random16_add_entropy(uint16_t entropy) { rand16seed += entropy; }
+
+inline int16_t sin16(uint16_t theta) {
+  static const uint16_t base[] = { 0, 6393, 12539, 18204, 23170, 27245, 30273, 32137 };
+  static const uint8_t slope[] = { 49, 48, 44, 38, 31, 23, 14, 4 };
+
+  uint16_t offset = (theta & 0x3FFF) >> 3;  // 0..2047
+  if (theta & 0x4000)
+    offset = 2047 - offset;
+  uint8_t section = offset / 256;  // 0..7
+  uint8_t secoffset8 = (uint8_t)offset / 2;
+  uint16_t mx = slope[section] * secoffset8;
+  int16_t y = mx + base[section];
+  if (theta & 0x8000)
+    y = -y;
+  return y;
+}
+
+inline int16_t cos16(uint16_t theta) {
+  return sin16(theta + 16384);
+}
+
+inline uint8_t sin8(uint8_t theta) {
+  static const uint8_t interleave[] = { 0, 49, 49, 41, 90, 27, 117, 10 };
+
+  uint8_t offset = theta;
+  if (theta & 0x40)
+    offset = (uint8_t)255 - offset;
+  offset &= 0x3F;  // 0..63
+  uint8_t secoffset = offset & 0x0F;  // 0..15
+  if (theta & 0x40)
+    secoffset++;
+  uint8_t section = offset >> 4;  // 0..3
+  uint8_t b = interleave[section * 2];
+  uint8_t m16 = interleave[section * 2 + 1];
+  uint8_t mx = (m16 * secoffset) >> 4;
+  int8_t y = mx + b;
+  if (theta & 0x80)
+    y = -y;
+  y += 128;
+  return y;
+}
+
+inline uint8_t cos8(uint8_t theta) {
+  return sin8(theta + 64);
+}
+
+#define GET_MILLIS millis
+
+inline uint16_t beat88(accum88 beatsPerMinute88, uint32_t timebase = 0) {
+  return ((GET_MILLIS() - timebase) * beatsPerMinute88 * 280) >> 16;
+}
+
+inline uint16_t beat16(accum88 beatsPerMinute, uint32_t timebase = 0) {
+  if (beatsPerMinute < 256)
+    beatsPerMinute <<= 8;
+  return beat88(beatsPerMinute, timebase);
+}
+
+inline uint8_t beat8(accum88 beatsPerMinute, uint32_t timebase = 0) {
+  return beat16(beatsPerMinute, timebase) >> 8;
+}
+
+inline uint16_t beatsin16(accum88 beatsPerMinute, uint16_t lowest = 0, uint16_t highest = 65535,
+                          uint32_t timebase = 0, uint16_t phaseOffset = 0) {
+  uint16_t beat = beat16(beatsPerMinute, timebase);
+  uint16_t beatsin = sin16(beat + phaseOffset) + 32768;
+  return lowest + scale16(beatsin, highest - lowest);
+}
+
+inline uint8_t beatsin8(accum88 beatsPerMinute, uint8_t lowest = 0, uint8_t highest = 255,
+                        uint32_t timebase = 0, uint8_t phaseOffset = 0) {
+  uint8_t beat = beat8(beatsPerMinute, timebase);
+  uint8_t beatsin = sin8(beat + phaseOffset);
+  return lowest + scale8(beatsin, highest - lowest);
+}
+
+// Colors
+
+struct CHSV
+{
+  union {
+    struct {
+      union { uint8_t hue; uint8_t h; };
+      union { uint8_t saturation; uint8_t sat; uint8_t s; };
+      union { uint8_t value; uint8_t val; uint8_t v; };
+    };
+    uint8_t raw[3];
+  };
+
+  CHSV() { };
+  CHSV(uint8_t h, uint8_t s, uint8_t v) : h(h), s(s), v(v) { };
+};
+
+struct CRGB;
+void hsv2rgb_rainbow(const CHSV& hsv, CRGB& rgb);
+
+struct CRGB
+{
+  union {
+    struct {
+      union { uint8_t r; uint8_t red; };
+      union { uint8_t g; uint8_t green; };
+      union { uint8_t b; uint8_t blue; };
+    };
+    uint8_t raw[3];
+  };
+
+  typedef enum {
+    AliceBlue = 0xF0F8FF,
+    Aqua = 0x00FFFF,
+    Aquamarine = 0x7FFFD4,
+    Black = 0x000000,
+    Blue = 0x0000FF,
+    CadetBlue = 0x5F9EA0,
+    CornflowerBlue = 0x6495ED,
+    Cyan = 0x00FFFF,
+    DarkBlue = 0x00008B,
+    DarkCyan = 0x008B8B,
+    DarkGreen = 0x006400,
+    DarkOliveGreen = 0x556B2F,
+    DarkRed = 0x8B0000,
+    ForestGreen = 0x228B22,
+    Green = 0x008000,
+    LawnGreen = 0x7CFC00,
+    LightBlue = 0xADD8E6,
+    LightGreen = 0x90EE90,
+    LightSkyBlue = 0x87CEFA,
+    LimeGreen = 0x32CD32,
+    Magenta = 0xFF00FF,
+    Maroon = 0x800000,
+    MediumAquamarine = 0x66CDAA,
+    MediumBlue = 0x0000CD,
+    MidnightBlue = 0x191970,
+    Navy = 0x000080,
+    OliveDrab = 0x6B8E23,
+    Orange = 0xFFA500,
+    Purple = 0x800080,
+    Red = 0xFF0000,
+    SeaGreen = 0x2E8B57,
+    SkyBlue = 0x87CEEB,
+    Teal = 0x008080,
+    White = 0xFFFFFF,
+    Yellow = 0xFFFF00,
+    YellowGreen = 0x9ACD32
+  } HTMLColorCode;
+
+  CRGB() { };
+  CRGB(uint8_t r, uint8_t g, uint8_t b) : r(r), g(g), b(b) { };
+  CRGB(uint32_t colorcode) : r((colorcode >> 16) & 0xFF), g((colorcode >> 8) & 0xFF), b(colorcode & 0xFF) { };
+  CRGB(HTMLColorCode colorcode) : CRGB((uint32_t)colorcode) { };
+  CRGB(const CHSV& hsv) { hsv2rgb_rainbow(hsv, *this); }
+
+  CRGB& operator=(const CHSV& hsv) {
+    hsv2rgb_rainbow(hsv, *this);
+    return *this;
+  }
+
+  uint8_t& operator[](uint8_t index) { return raw[index]; }
+  const uint8_t& operator[](uint8_t index) const { return raw[index]; }
+
+  CRGB& setRGB(uint8_t nr, uint8_t ng, uint8_t nb) {
+    r = nr;
+    g = ng;
+    b = nb;
+    return *this;
+  }
+
+  CRGB& operator+=(const CRGB& rhs) {
+    r = qadd8(r, rhs.r);
+    g = qadd8(g, rhs.g);
+    b = qadd8(b, rhs.b);
+    return *this;
+  }
+
+  CRGB& operator-=(const CRGB& rhs) {
+    r = qsub8(r, rhs.r);
+    g = qsub8(g, rhs.g);
+    b = qsub8(b, rhs.b);
+    return *this;
+  }
+
+  // per channel maximum
+  CRGB& operator|=(const CRGB& rhs) {
+    if (rhs.r > r) r = rhs.r;
+    if (rhs.g > g) g = rhs.g;
+    if (rhs.b > b) b = rhs.b;
+    return *this;
+  }
+
+  // per channel minimum
+  CRGB& operator&=(const CRGB& rhs) {
+    if (rhs.r < r) r = rhs.r;
+    if (rhs.g < g) g = rhs.g;
+    if (rhs.b < b) b = rhs.b;
+    return *this;
+  }
+
+  CRGB& nscale8(uint8_t scale) {
+    r = ::scale8(r, scale);
+    g = ::scale8(g, scale);
+    b = ::scale8(b, scale);
+    return *this;
+  }
+
+  CRGB& nscale8_video(uint8_t scale) {
+    r = ::scale8_video(r, scale);
+    g = ::scale8_video(g, scale);
+    b = ::scale8_video(b, scale);
+    return *this;
+  }
+
+  CRGB& operator%=(uint8_t scale) {
+    return nscale8_video(scale);
+  }
+
+  CRGB& fadeToBlackBy(uint8_t fade) {
+    return nscale8(255 - fade);
+  }
+
+  CRGB scale8(uint8_t scale) const {
+    CRGB color = *this;
+    return color.nscale8(scale);
+  }
+
+  operator bool() const {
+    return r || g || b;
+  }
+};
+
+inline bool operator==(const CRGB& lhs, const CRGB& rhs) {
+  return lhs.r == rhs.r && lhs.g == rhs.g && lhs.b == rhs.b;
+}
+
+inline bool operator!=(const CRGB& lhs, const CRGB& rhs) {
+  return !(lhs == rhs);
+}
+
+inline CRGB operator+(const CRGB& p1, const CRGB& p2) {
+  return CRGB(qadd8(p1.r, p2.r), qadd8(p1.g, p2.g), qadd8(p1.b, p2.b));
+}
+
+inline CRGB& nblend(CRGB& existing, const CRGB& overlay, fract8 amountOfOverlay) {
+  if (amountOfOverlay == 0)
+    return existing;
+  if (amountOfOverlay == 255) {
+    existing = overlay;
+    return existing;
+  }
+  existing.red = blend8(existing.red, overlay.red, amountOfOverlay);
+  existing.green = blend8(existing.green, overlay.green, amountOfOverlay);
+  existing.blue = blend8(existing.blue, overlay.blue, amountOfOverlay);
+  return existing;
+}
+
+inline CRGB blend(const CRGB& p1, const CRGB& p2, fract8 amountOfP2) {
+  CRGB result = p1;
+  return nblend(result, p2, amountOfP2);
+}
+
+// Whole strip
+
+inline void fill_solid(CRGB* leds, int numToFill, const CRGB& color) {
+  for (int i = 0; i < numToFill; i++)
+    leds[i] = color;
+}
+
+inline void fill_rainbow(CRGB* leds, int numToFill, uint8_t initialhue, uint8_t deltahue = 5) {
+  CHSV hsv(initialhue, 240, 255);
+  for (int i = 0; i < numToFill; i++) {
+    leds[i] = hsv;
+    hsv.hue += deltahue;
+  }
+}
+
+inline void nscale8(CRGB* leds, uint16_t numLeds, uint8_t scale) {
+  for (uint16_t i = 0; i < numLeds; i++)
+    leds[i].nscale8(scale);
+}
+
+inline void fadeToBlackBy(CRGB* leds, uint16_t numLeds, uint8_t fadeBy) {
+  nscale8(leds, numLeds, 255 - fadeBy);
+}
+
+// Palettes
+
+typedef enum { NOBLEND = 0, LINEARBLEND = 1 } TBlendType;
+
+typedef uint32_t TProgmemRGBPalette16[16];
+
+extern const TProgmemRGBPalette16 CloudColors_p;
+extern const TProgmemRGBPalette16 LavaColors_p;
+extern const TProgmemRGBPalette16 OceanColors_p;
+extern const TProgmemRGBPalette16 ForestColors_p;
+extern const TProgmemRGBPalette16 RainbowColors_p;
+extern const TProgmemRGBPalette16 RainbowStripeColors_p;
+extern const TProgmemRGBPalette16 PartyColors_p;
+extern const TProgmemRGBPalette16 HeatColors_p;
+
+class CRGBPalette16
+{
+public:
+  CRGB entries[16];
+
+  CRGBPalette16() { };
+
+  CRGBPalette16(const TProgmemRGBPalette16& palette) {
+    *this = palette;
+  }
+
+  CRGBPalette16& operator=(const TProgmemRGBPalette16& palette) {
+    for (uint8_t i = 0; i < 16; i++)
+      entries[i] = CRGB(palette[i]);
+    return *this;
+  }
+
+  bool operator==(const CRGBPalette16& rhs) const {
+    return memcmp(entries, rhs.entries, sizeof(entries)) == 0;
+  }
+
+  bool operator!=(const CRGBPalette16& rhs) const {
+    return !(*this == rhs);
+  }
+
+  CRGB& operator[](uint8_t index) { return entries[index]; }
+  const CRGB& operator[](uint8_t index) const { return entries[index]; }
+};
+
+inline CRGB ColorFromPalette(const CRGBPalette16& palette, uint8_t index, uint8_t brightness = 255,
+                             TBlendType blendType = LINEARBLEND) {
+  uint8_t hi4 = index >> 4;
+  uint8_t lo4 = index & 0x0F;
+  const CRGB* entry = &palette.entries[hi4];
+  uint8_t red1 = entry->red;
+  uint8_t green1 = entry->green;
+  uint8_t blue1 = entry->blue;
+
+  if (lo4 && blendType != NOBLEND) {
+    entry = hi4 == 15 ? &palette.entries[0] : entry + 1;
+    uint8_t f2 = lo4 << 4;
+    uint8_t f1 = 255 - f2;
+    red1 = scale8(red1, f1) + scale8(entry->red, f2);
+    green1 = scale8(green1, f1) + scale8(entry->green, f2);
+    blue1 = scale8(blue1, f1) + scale8(entry->blue, f2);
+  }
+
+  if (brightness != 255) {
+    if (brightness) {
+      brightness++;  // adjust for rounding
+#if FASTLED_SCALE8_FIXED == 1
+      if (red1) red1 = scale8(red1, brightness);
+      if (green1) green1 = scale8(green1, brightness);
+      if (blue1) blue1 = scale8(blue1, brightness);
+#else
+      if (red1) red1 = scale8(red1, brightness) + 1;
+      if (green1) green1 = scale8(green1, brightness) + 1;
+      if (blue1) blue1 = scale8(blue1, brightness) + 1;
+#endif
+    } else {
+      red1 = 0;
+      green1 = 0;
+      blue1 = 0;
+    }
+  }
+
+  return CRGB(red1, green1, blue1);
+}
+
+inline void fill_palette(CRGB* leds, uint16_t numLeds, uint8_t startIndex, uint8_t incIndex,
+                         const CRGBPalette16& palette, uint8_t brightness, TBlendType blendType) {
+  uint8_t colorIndex = startIndex;
+  for (uint16_t i = 0; i < numLeds; i++) {
+    leds[i] = ColorFromPalette(palette, colorIndex, brightness, blendType);
+    colorIndex += incIndex;
+  }
+}
+
+// Controllers
+
+class CLEDController
+{
+public:
+  CLEDController() {
+    if (!m_pHead)
+      m_pHead = this;
+    if (m_pTail)
+      m_pTail->m_pNext = this;
+    m_pTail = this;
+  }
+
+  // controllers live as long as the program on a device, tests create and destroy them
+  virtual ~CLEDController() {
+    CLEDController* previous = 0;
+    for (CLEDController* controller = m_pHead; controller; controller = controller->m_pNext) {
+      if (controller == this)
+        break;
+      previous = controller;
+    }
+    if (previous)
+      previous->m_pNext = m_pNext;
+    if (m_pHead == this)
+      m_pHead = m_pNext;
+    if (m_pTail == this)
+      m_pTail = previous;
+  }
+
+  virtual void init() = 0;
+
+  void show(const CRGB* data, int nLeds, uint8_t brightness) {
+    show(data, nLeds, getAdjustment(brightness));
+  }
+
+  void showColor(const CRGB& data, int nLeds, uint8_t brightness) {
+    showColor(data, nLeds, getAdjustment(brightness));
+  }
+
+  void showLeds(uint8_t brightness = 255) {
+    show(m_Data, m_nLeds, getAdjustment(brightness));
+  }
+
+  CLEDController& setLeds(CRGB* data, int nLeds) {
+    m_Data = data;
+    m_nLeds = nLeds;
+    return *this;
+  }
+
+  CRGB* leds() { return m_Data; }
+  int size() { return m_nLeds; }
+  CLEDController* next() { return m_pNext; }
+  static CLEDController* head() { return m_pHead; }
+
+  // no color correction or temperature
+  CRGB getAdjustment(uint8_t scale) {
+    return CRGB(scale, scale, scale);
+  }
+
+protected:
+  CRGB* m_Data = 0;
+  int m_nLeds = 0;
+  CLEDController* m_pNext = 0;
+  static CLEDController* m_pHead;
+  static CLEDController* m_pTail;
+
+  virtual void showColor(const CRGB& data, int nLeds, CRGB scale) = 0;
+  virtual void show(const CRGB* data, int nLeds, CRGB scale) = 0;
+};
+
+class CFastLED
+{
+public:
+  void setBrightness(uint8_t scale) { m_Scale = scale; }
+  uint8_t getBrightness() { return m_Scale; }
+
+  void show(uint8_t scale) {
+    for (CLEDController* controller = CLEDController::head(); controller; controller = controller->next())
+      controller->showLeds(scale);
+  }
+
+  void show() { show(m_Scale); }
+
+  // show the leds again and again until ms passed, as FastLED does for dithering
+  void delay(unsigned long ms) {
+    unsigned long start = millis();
+    do {
+      ::delay(1);
+      show();
+      yield();
+    } while (millis() - start < ms);
+  }
+
+  int count() {
+    int count = 0;
+    for (CLEDController* controller = CLEDController::head(); controller; controller = controller->next())
+      count++;
+    return count;
+  }
+
+private:
+  uint8_t m_Scale = 255;
+};
+
+extern CFastLED FastLED;
+
+class CEveryNMillis
+{
+public:
+  CEveryNMillis(uint32_t period) : _previous(millis()), _period(period) { };
+
+  bool ready() {
+    uint32_t now = millis();
+    if (now - _previous < _period)
+      return false;
+    _previous = now;
+    return true;
+  }
+
+private:
+  uint32_t _previous;
+  uint32_t _period;
+};
+
+#define FASTLED_CONCAT_(a, b) a##b
+#define FASTLED_CONCAT(a, b) FASTLED_CONCAT_(a, b)
+#define EVERY_N_MILLIS(N) \
+  static CEveryNMillis FASTLED_CONCAT(everyNMillis, __LINE__)(N); if (FASTLED_CONCAT(everyNMillis, __LINE__).ready())
+#define EVERY_N_SECONDS(N) EVERY_N_MILLIS((N) * 1000UL)
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+class IPAddress
+{
+public:
+  IPAddress() { };
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _bytes{a, b, c, d} { };
+  explicit IPAddress(uint32_t address) { memcpy(_bytes, &address, 4); }
+
+  operator uint32_t() const {
+    uint32_t address;
+    memcpy(&address, _bytes, 4);
+    return address;
+  }
+
+  uint8_t operator[](int index) const { return _bytes[index]; }
+  uint8_t& operator[](int index) { return _bytes[index]; }
+
+  bool operator==(const IPAddress& other) const {
+    return memcmp(_bytes, other._bytes, 4) == 0;
+  }
+
+private:
+  uint8_t _bytes[4] = {};
+};
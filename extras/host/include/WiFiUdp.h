@@ -0,0 +1,138 @@
+#pragma once
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#include <Udp.h>
+
+// UDP over a non-blocking POSIX socket, with the interface of the ESP8266/ESP32 WiFiUDP
+class WiFiUDP : public UDP
+{
+public:
+  ~WiFiUDP() {
+    stop();
+  }
+
+  uint8_t begin(uint16_t port) override {
+    if (!open())
+      return 0;
+    int one = 1;
+    setsockopt(_socket, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    int bufferSize = 4 << 20;  // frames of thousands of leds arrive in bursts of packets
+    setsockopt(_socket, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    return bind(_socket, (sockaddr*)&address, sizeof(address)) == 0;
+  }
+
+  void stop() override {
+    if (_socket >= 0)
+      close(_socket);
+    _socket = -1;
+  }
+
+  int beginPacket(IPAddress ip, uint16_t port) override {
+    if (!open())
+      return 0;
+    _output.clear();
+    _destination = {};
+    _destination.sin_family = AF_INET;
+    _destination.sin_port = htons(port);
+    uint32_t address = ip;
+    memcpy(&_destination.sin_addr, &address, 4);
+    return 1;
+  }
+
+  int beginPacket(const char* host, uint16_t port) override {
+    in_addr address;
+    if (inet_aton(host, &address) == 0)
+      return 0;
+    return beginPacket(IPAddress(address.s_addr), port);
+  }
+
+  int endPacket() override {
+    ssize_t sent = sendto(_socket, _output.data(), _output.size(), 0, (sockaddr*)&_destination, sizeof(_destination));
+    return sent == (ssize_t)_output.size();
+  }
+
+  size_t write(uint8_t c) override {
+    _output.push_back(c);
+    return 1;
+  }
+
+  size_t write(const uint8_t* buffer, size_t size) override {
+    _output.insert(_output.end(), buffer, buffer + size);
+    return size;
+  }
+
+  using UDP::write;
+
+  int parsePacket() override {
+    _input.resize(65536);
+    _position = 0;
+    socklen_t length = sizeof(_source);
+    ssize_t size = _socket < 0 ? -1 : recvfrom(_socket, _input.data(), _input.size(), 0, (sockaddr*)&_source, &length);
+    _input.resize(size > 0 ? size : 0);
+    return _input.size();
+  }
+
+  int available() override {
+    return _input.size() - _position;
+  }
+
+  int read() override {
+    return _position < _input.size() ? _input[_position++] : -1;
+  }
+
+  int read(unsigned char* buffer, size_t size) override {
+    size = std::min(size, _input.size() - _position);
+    memcpy(buffer, _input.data() + _position, size);
+    _position += size;
+    return size;
+  }
+
+  int read(char* buffer, size_t size) override {
+    return read((unsigned char*)buffer, size);
+  }
+
+  int peek() override {
+    return _position < _input.size() ? _input[_position] : -1;
+  }
+
+  void flush() override {
+    _input.clear();
+    _position = 0;
+  }
+
+  IPAddress remoteIP() override {
+    return IPAddress(_source.sin_addr.s_addr);
+  }
+
+  uint16_t remotePort() override {
+    return ntohs(_source.sin_port);
+  }
+
+private:
+  int _socket = -1;
+  sockaddr_in _destination = {};
+  sockaddr_in _source = {};
+  std::vector<uint8_t> _output;
+  std::vector<uint8_t> _input;
+  size_t _position = 0;
+
+  bool open() {
+    if (_socket < 0) {
+      _socket = socket(AF_INET, SOCK_DGRAM, 0);
+      if (_socket >= 0)
+        fcntl(_socket, F_SETFL, O_NONBLOCK);
+    }
+    return _socket >= 0;
+  }
+};
@@ -0,0 +1,33 @@
+// Render an effect configuration headless into a recording, e.g. to tune its parameters offline
+//
+//   render '{"effect":{"name":"fire","cooling":70}}' 3000 fire.lefr [leds [fps]]
+#include "headless.h"
+
+int main(int argc, char** argv) {
+  if (argc < 4) {
+    fprintf(stderr, "usage: %s <json command> <frames> <output> [leds [fps]]\n", argv[0]);
+    return 2;
+  }
+  uint32_t frames = strtoul(argv[2], 0, 10);
+  uint16_t size = argc > 4 ? strtoul(argv[4], 0, 10) : 60;
+  uint8_t fps = argc > 5 ? strtoul(argv[5], 0, 10) : 30;
+
+  MemoryPrint print;
+  if (!renderHeadless(print, argv[1], frames, size, fps)) {
+    fprintf(stderr, "%s: invalid command, led count or frame rate\n", argv[0]);
+    return 1;
+  }
+
+  FILE* file = fopen(argv[3], "wb");
+  if (!file) {
+    perror(argv[3]);
+    return 1;
+  }
+  bool written = fwrite(print.data.data(), 1, print.data.size(), file) == print.data.size();
+  if (fclose(file) != 0 || !written) {
+    perror(argv[3]);
+    return 1;
+  }
+  printf("%u frames of %u leds, %zu bytes\n", frames, size, print.data.size());
+  return 0;
+}
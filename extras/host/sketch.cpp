@@ -0,0 +1,9 @@
+// Run an Arduino sketch on the host: setup() then loop() once, as the sketches built here do all their work in setup()
+void setup();
+void loop();
+
+int main() {
+  setup();
+  loop();
+  return 0;
+}
@@ -0,0 +1,19 @@
+// Applause begun again on fewer leds flashes within them only
+#include "test.h"
+
+CRGB leds[90];
+
+int main() {
+  ApplauseEffect applause("applause");
+  FrameContext frame(0, FrameContext::RATE_PERIOD, FrameContext::RATE_PERIOD);
+  applause.begin(leds, 90);
+  for (uint8_t i = 0; i < 10; i++)
+    applause.loop(frame);
+
+  fill_solid(leds, 90, CRGB::Black);
+  applause.begin(leds, 30);
+  applause.loop(frame);
+  for (uint8_t i = 30; i < 90; i++)
+    CHECK(leds[i] == CRGB(CRGB::Black));
+  return failures;
+}
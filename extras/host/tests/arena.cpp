@@ -0,0 +1,76 @@
+// With LEDEFFECT_JSON_ARENA, the arena is allocated once per strip or group, shared by its segments, and freed with it
+#define LEDEFFECT_JSON_ARENA
+#include "test.h"
+
+#include <new>
+
+static uint32_t arrays = 0;
+
+void* operator new[](size_t size) {
+  arrays++;
+  return ::operator new(size);
+}
+
+void operator delete[](void* memory) noexcept {
+  ::operator delete(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+  ::operator delete(memory);
+}
+
+CRGB leds[60];
+CRGB segmentBuffer[30];
+BaseEffect* stripEffects[] = { new RainbowEffect("rainbow"), new SolidEffect("solid") };
+BaseEffect* firstEffects[] = { new RainbowEffect("rainbow"), new SolidEffect("solid") };
+BaseEffect* secondEffects[] = { new RainbowEffect("rainbow"), new SolidEffect("solid") };
+LedEffect strip(stripEffects, 2);
+LedEffect first(firstEffects, 2);
+LedEffect second(secondEffects, 2);
+LedEffect* segments[] = { &first, &second };
+LedEffectGroup group(segments, 2);
+
+int main() {
+  TestController controller;
+  controller.setLeds(leds, 60);
+
+  strip.begin(&controller);
+  uint32_t before = arrays;
+  strip.begin(&controller);
+  strip.begin(&controller);
+  CHECK_EQUAL(before, arrays);
+  CHECK(command(strip, "{\"brightness\":10,\"effect\":{\"name\":\"solid\",\"color_rgb\":[1,2,3]}}"));
+  CHECK(strstr(state(strip).c_str(), "\"color_rgb\":[1,2,3]"));
+
+  // commands larger than the buffer computed from the effects are rejected
+  CHECK(!command(strip, "{\"a\":1,\"b\":2,\"c\":3,\"d\":4,\"e\":5,\"f\":6,\"g\":7,\"h\":8,\"i\":9,\"j\":10,"
+                        "\"effect\":{\"name\":\"solid\",\"rate\":1,\"color_hsv\":[1,2,3],\"x\":[1,2,3,4,5,6,7,8]}}"));
+
+  // segments share the arena of the group, only a command given to a segment directly allocates one for it
+  first.beginSegment(&controller, 0, 30, segmentBuffer);
+  second.beginSegment(&controller);
+  before = arrays;
+  group.begin();
+  CHECK_EQUAL(before + 1, arrays);
+  first.beginSegment(&controller, 0, 30, segmentBuffer);
+  group.begin();
+  std::string json("{\"segment\":1,\"brightness\":20}");
+  CHECK(group.deserialize(&json[0]));
+  CHECK(strstr(state(second).c_str(), "\"brightness\":20"));
+  json = "{\"segment\":1,\"brightness\":30}";
+  CHECK(group.queue(&json[0]));
+  CHECK_EQUAL(before + 1, arrays);
+  CHECK(command(second, "{\"effect\":{\"name\":\"solid\"}}"));
+  CHECK(command(second, "{\"brightness\":40}"));
+  CHECK(strstr(state(second).c_str(), "\"solid\""));
+  CHECK_EQUAL(before + 2, arrays);
+
+  // the arena frees its memory
+  {
+    JsonArena arena(64);
+    CHECK_EQUAL((size_t)64, arena.capacity());
+    CHECK(arena.createObject().success());
+  }
+
+  return failures;
+}
@@ -0,0 +1,56 @@
+// Binary commands apply the same changes as their JSON counterparts
+#include "test.h"
+
+#define EFFECTS { \
+  new RainbowEffect("rainbow"), \
+  new SolidEffect("solid"), \
+  new TwinkleEffect<90>("twinkle"), \
+  new ApplauseEffect("applause"), \
+  new JuggleEffect("juggle"), \
+  new FireEffect<90>("fire"), \
+  new PaletteEffect("palette", "lava") \
+}
+
+CRGB jsonLeds[90];
+CRGB binaryLeds[90];
+BaseEffect* jsonEffects[] = EFFECTS;
+BaseEffect* binaryEffects[] = EFFECTS;
+LedEffect jsonStrip(jsonEffects, 7);
+LedEffect binaryStrip(binaryEffects, 7);
+
+struct Command
+{
+  const char* json;
+  std::string binary;
+};
+
+const Command commands[] = {
+  { "{\"state\":\"ON\",\"brightness\":128}", std::string("\x01\x01\x02\x80", 4) },
+  { "{\"brightness\":128,\"effect\":{\"name\":\"solid\",\"rate\":24}}", std::string("\x02\x80\x05\x01\x02\x18", 6) },
+  { "{\"state\":\"ON\",\"effect\":{\"name\":\"solid\",\"color_rgb\":[255,128,0]}}",
+    std::string("\x01\x01\x05\x01\x01\xff\x80\x00", 8) },
+  { "{\"effect\":{\"name\":\"twinkle\",\"palette\":\"ocean\",\"density\":100,\"fade_rate\":24}}",
+    std::string("\x05\x02\x02\x05ocean\x07\x64\x06\x18", 13) },
+  { "{\"state\":\"OFF\"}", std::string("\x01\x00", 2) }
+};
+
+int main() {
+  TestController jsonController;
+  TestController binaryController;
+  jsonController.setLeds(jsonLeds, 90);
+  binaryController.setLeds(binaryLeds, 90);
+  jsonStrip.begin(&jsonController);
+  binaryStrip.begin(&binaryController);
+
+  for (const Command& command : commands) {
+    CHECK(::command(jsonStrip, command.json));
+    CHECK(binaryStrip.deserialize((const uint8_t*)command.binary.data(), command.binary.size()));
+    CHECK_EQUAL(state(jsonStrip), state(binaryStrip));
+  }
+
+  // truncated and unknown commands are rejected
+  CHECK(!binaryStrip.deserialize((const uint8_t*)"\x02", 1));
+  CHECK(!binaryStrip.deserialize((const uint8_t*)"\x05\x09", 2));
+
+  return failures;
+}
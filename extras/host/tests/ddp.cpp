@@ -0,0 +1,87 @@
+// DdpSink sends the packets of the leds that changed, and again those it failed to send
+#include "test.h"
+
+#include <vector>
+
+// UDP keeping the packets sent, failing to send when told to
+class TestUdp : public UDP
+{
+public:
+  std::vector<std::string> packets;
+  bool fail = false;
+
+  uint8_t begin(uint16_t /*port*/) override { return 1; }
+  void stop() override { }
+  int beginPacket(IPAddress /*ip*/, uint16_t /*port*/) override { _packet.clear(); return 1; }
+  int beginPacket(const char* /*host*/, uint16_t /*port*/) override { _packet.clear(); return 1; }
+
+  int endPacket() override {
+    if (fail)
+      return 0;
+    packets.push_back(_packet);
+    return 1;
+  }
+
+  size_t write(uint8_t c) override { _packet.push_back(c); return 1; }
+  size_t write(const uint8_t* buffer, size_t size) override { _packet.append((const char*)buffer, size); return size; }
+  using UDP::write;
+
+  int parsePacket() override { return 0; }
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int read(unsigned char* /*buffer*/, size_t /*size*/) override { return 0; }
+  int read(char* /*buffer*/, size_t /*size*/) override { return 0; }
+  int peek() override { return -1; }
+  void flush() override { }
+  IPAddress remoteIP() override { return IPAddress(); }
+  uint16_t remotePort() override { return 0; }
+
+private:
+  std::string _packet;
+};
+
+// byte offset of the leds of a packet
+uint32_t offset(const std::string& packet) {
+  return (uint8_t)packet[4] << 24 | (uint8_t)packet[5] << 16 | (uint8_t)packet[6] << 8 | (uint8_t)packet[7];
+}
+
+CRGB leds[1000];
+
+int main() {
+  TestUdp udp;
+  DdpSink sink(udp, IPAddress(127, 0, 0, 1));
+  sink.keyframeInterval = 0;
+  fill_solid(leds, 1000, CRGB::Red);
+
+  // a keyframe, in 3 packets
+  sink.show(leds, 1000, 255);
+  CHECK_EQUAL(3u, udp.packets.size());
+  CHECK_EQUAL(0x41, udp.packets[2][0]);
+  sink.keyframeInterval = 30;
+
+  // the first packet changed, it carries the push flag
+  udp.packets.clear();
+  leds[0] = CRGB::Blue;
+  sink.show(leds, 1000, 255);
+  CHECK_EQUAL(1u, udp.packets.size());
+  CHECK_EQUAL(0u, offset(udp.packets[0]));
+  CHECK_EQUAL(0x41, udp.packets[0][0]);
+
+  // nothing changed
+  udp.packets.clear();
+  sink.show(leds, 1000, 255);
+  CHECK_EQUAL(0u, udp.packets.size());
+
+  // the change could not be sent, it is sent with the next frame
+  leds[0] = CRGB::Green;
+  udp.fail = true;
+  sink.show(leds, 1000, 255);
+  CHECK_EQUAL(1u, sink.failures());
+  udp.fail = false;
+  sink.show(leds, 1000, 255);
+  CHECK_EQUAL(1u, udp.packets.size());
+  if (udp.packets.size() == 1)
+    CHECK_EQUAL(CRGB(CRGB::Green), *(const CRGB*)&udp.packets[0][LEDEFFECT_DDP_HEADER_SIZE]);
+
+  return failures;
+}
@@ -0,0 +1,93 @@
+// Every effect renders the frames of its golden recording in golden/, read back through a memory map
+//
+// Run with --update from extras/host to record them again after a change of the rendering.
+#include "test.h"
+#include "../headless.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define GOLDEN_LEDS 60
+#define GOLDEN_FPS 30
+#define GOLDEN_FRAMES 90
+
+struct Golden
+{
+  const char* file;
+  const char* json;
+};
+
+const Golden goldens[] = {
+  { "golden/rainbow.lefr", "{\"brightness\":255,\"effect\":{\"name\":\"rainbow\",\"delta_hue\":4}}" },
+  { "golden/solid.lefr", "{\"brightness\":255,\"effect\":{\"name\":\"solid\",\"color_rgb\":[255,128,0]}}" },
+  { "golden/twinkle.lefr", "{\"brightness\":255,\"effect\":{\"name\":\"twinkle\",\"palette\":\"ocean\",\"density\":100}}" },
+  { "golden/applause.lefr", "{\"brightness\":255,\"effect\":{\"name\":\"applause\"}}" },
+  { "golden/juggle.lefr", "{\"brightness\":255,\"effect\":{\"name\":\"juggle\",\"dots\":4}}" },
+  { "golden/fire.lefr", "{\"brightness\":255,\"effect\":{\"name\":\"fire\",\"cooling\":70}}" },
+  { "golden/palette.lefr", "{\"brightness\":255,\"effect\":{\"name\":\"palette\",\"palette\":\"party\"}}" }
+};
+
+bool update(const Golden& golden, const MemoryPrint& rendered) {
+  FILE* file = fopen(golden.file, "wb");
+  if (!file)
+    return false;
+  bool written = fwrite(rendered.data.data(), 1, rendered.data.size(), file) == rendered.data.size();
+  return fclose(file) == 0 && written;
+}
+
+// compare the frames of the recording at golden.file with the rendered ones
+void compare(const Golden& golden, const MemoryPrint& rendered) {
+  int file = open(golden.file, O_RDONLY);
+  struct stat status;
+  if (file < 0 || fstat(file, &status) != 0) {
+    if (file >= 0)
+      close(file);
+    printf("%s: missing, run with --update\n", golden.file);
+    failures++;
+    return;
+  }
+  void* data = mmap(0, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+  close(file);
+  CHECK(data != MAP_FAILED);
+  if (data == MAP_FAILED)
+    return;
+
+  FrameReader expected((const uint8_t*)data, status.st_size);
+  FrameReader actual(rendered.data.data(), rendered.data.size());
+  CHECK(expected.valid());
+  CHECK_EQUAL(expected.size(), actual.size());
+  CHECK_EQUAL(expected.fps(), actual.fps());
+  if (expected.valid() && expected.size() == actual.size()) {
+    std::vector<CRGB> expectedLeds(expected.size());
+    std::vector<CRGB> actualLeds(actual.size());
+    uint8_t expectedBrightness = 0;
+    uint8_t actualBrightness = 0;
+    for (;;) {
+      bool more = expected.next(expectedLeds.data(), &expectedBrightness);
+      CHECK_EQUAL(more, actual.next(actualLeds.data(), &actualBrightness));
+      if (!more)
+        break;
+      if (expectedLeds != actualLeds || expectedBrightness != actualBrightness) {
+        printf("%s: frame %u differs\n", golden.file, expected.frames() - 1);
+        failures++;
+        break;
+      }
+    }
+  }
+  munmap(data, status.st_size);
+}
+
+int main(int argc, char** argv) {
+  bool updating = argc > 1 && strcmp(argv[1], "--update") == 0;
+  for (const Golden& golden : goldens) {
+    MemoryPrint rendered;
+    CHECK(renderHeadless(rendered, golden.json, GOLDEN_FRAMES, GOLDEN_LEDS, GOLDEN_FPS));
+    if (updating)
+      CHECK(update(golden, rendered));
+    else
+      compare(golden, rendered);
+  }
+  return failures;
+}
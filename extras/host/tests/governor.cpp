@@ -0,0 +1,54 @@
+// Frames of the non-blocking loop stay a period apart while the adaptive frame rate ramps up
+#include "test.h"
+
+#include <vector>
+
+CRGB leds[90];
+BaseEffect* effects[] = {
+  new SolidEffect("solid"),
+  new JuggleEffect("juggle")
+};
+LedEffect strip(effects, 2);
+
+int main() {
+  TestController controller;
+  controller.setLeds(leds, 90);
+  strip.blocking = false;
+  strip.fps = 60;
+  strip.minFps = 10;
+  hostFreezeTime(1000000);
+  strip.begin(&controller);
+
+  // a static effect settles at a low rate
+  for (uint32_t i = 0; i < 1000; i++) {
+    strip.loop();
+    hostAdvanceTime(1000);
+  }
+  CHECK(strip.targetFps() < 60);
+
+  // a busy one ramps up to the max fps, loop() called every ms
+  CHECK(command(strip, "{\"effect\":{\"name\":\"juggle\"}}"));
+  std::vector<uint32_t> starts;
+  std::vector<uint8_t> rates;
+  uint32_t frames = strip.scheduler().frames;
+  for (uint32_t i = 0; i < 2000; i++) {
+    strip.loop();
+    if (strip.scheduler().frames != frames) {
+      frames = strip.scheduler().frames;
+      starts.push_back(micros());
+      rates.push_back(strip.targetFps());
+    }
+    hostAdvanceTime(1000);
+  }
+  CHECK_EQUAL(60, strip.targetFps());
+
+  // each frame the period of the rate after the previous one later than it, less the ms between the calls
+  for (size_t i = 1; i < starts.size(); i++) {
+    if (starts[i] - starts[i - 1] + 1000 <= 1000000UL / rates[i - 1]) {
+      printf("frame %u: %u us after the previous one at %u fps\n", (unsigned)i, starts[i] - starts[i - 1],
+        rates[i - 1]);
+      failures++;
+    }
+  }
+  return failures;
+}
@@ -0,0 +1,64 @@
+// Commands queued to the segments of a group are applied and notified once at the next frame of the group
+#include "test.h"
+
+#define EFFECTS { \
+  new RainbowEffect("rainbow"), \
+  new SolidEffect("solid") \
+}
+
+CRGB leds[90];
+CRGB segmentLeds[2][45];
+BaseEffect* firstEffects[] = EFFECTS;
+BaseEffect* secondEffects[] = EFFECTS;
+LedEffect first(firstEffects, 2);
+LedEffect second(secondEffects, 2);
+LedEffect* segments[] = { &first, &second };
+LedEffectGroup group(segments, 2);
+
+uint32_t notified[2];
+
+inline bool queue(const char* json) {
+  std::string copy(json);
+  return group.queue(&copy[0]);
+}
+
+int main() {
+  TestController controller;
+  controller.setLeds(leds, 90);
+  first.beginSegment(&controller, 0, 45, segmentLeds[0]);
+  second.beginSegment(&controller, 45, 45, segmentLeds[1]);
+  group.blocking = false;
+  group.begin();
+  first.stateCallback = [](LedEffect&) { notified[0]++; };
+  second.stateCallback = [](LedEffect&) { notified[1]++; };
+  hostFreezeTime(1000000);
+  group.loop();
+
+  // a burst of commands, left untouched until the next frame
+  std::string before = state(second);
+  CHECK(queue("{\"segment\":1,\"brightness\":10}"));
+  CHECK(queue("{\"segment\":1,\"brightness\":20,\"effect\":{\"name\":\"rainbow\",\"rate\":3}}"));
+  CHECK(group.queue((const uint8_t*)"\x01\x02\x80", 3));
+  CHECK(queue("{\"brightness\":40}"));
+  CHECK_EQUAL(before, state(second));
+  CHECK_EQUAL(0u, notified[1]);
+
+  hostAdvanceTime(1000000);
+  CHECK(group.loop());
+  CHECK_EQUAL(128, second.brightness);
+  CHECK_EQUAL(40, first.brightness);
+  CHECK_EQUAL(1u, notified[0]);
+  CHECK_EQUAL(1u, notified[1]);
+  CHECK(state(second).find("\"rate\":3") != std::string::npos);
+
+  // nothing queued, nothing notified
+  hostAdvanceTime(1000000);
+  group.loop();
+  CHECK_EQUAL(1u, notified[1]);
+
+  // unknown segments
+  CHECK(!queue("{\"segment\":2,\"brightness\":10}"));
+  CHECK(!group.queue((const uint8_t*)"\x02\x02\x0a", 3));
+  CHECK(!group.queue((const uint8_t*)"", 0));
+  return failures;
+}
@@ -0,0 +1,84 @@
+// ColorKernels give the results of FastLED's per led operations, for every count through the vector, word and
+// channel paths and every amount
+#include "test.h"
+
+// blend8() of FastLED 3.3 with FASTLED_BLEND_FIXED, as written there
+uint8_t fastledBlend8(uint8_t a, uint8_t b, uint8_t amountOfB) {
+  uint16_t partial;
+  partial = (a << 8) | b;
+  partial += (b * amountOfB);
+  partial -= (a * amountOfB);
+  return partial >> 8;
+}
+
+#define MAX_COUNT 64
+
+CRGB leds[MAX_COUNT];
+CRGB other[MAX_COUNT];
+CRGB expected[MAX_COUNT];
+
+void randomize() {
+  for (uint16_t i = 0; i < MAX_COUNT; i++) {
+    leds[i] = CRGB(random8(), random8(), random8());
+    other[i] = CRGB(random8(), random8(), random8());
+  }
+  // the extremes of every channel
+  leds[0] = CRGB(255, 0, 255);
+  other[0] = CRGB(255, 255, 0);
+}
+
+bool same(uint16_t count) {
+  return memcmp(leds, expected, count * sizeof(CRGB)) == 0;
+}
+
+int main() {
+  for (uint16_t count = 0; count <= MAX_COUNT; count++) {
+    for (uint16_t amount = 0; amount < 256; amount++) {
+      randomize();
+      for (uint16_t i = 0; i < count; i++) {
+        expected[i] = leds[i];
+        nblend(expected[i], other[i], amount);
+        if (amount != 0 && amount != 255) {
+          for (uint8_t c = 0; c < 3; c++)
+            CHECK_EQUAL(fastledBlend8(leds[i].raw[c], other[i].raw[c], amount), expected[i].raw[c]);
+        }
+      }
+      ColorKernels::blend(leds, other, count, amount);
+      if (!same(count)) {
+        printf("blend of %u leds by %u\n", count, amount);
+        CHECK(false);
+      }
+
+      randomize();
+      for (uint16_t i = 0; i < count; i++)
+        expected[i] = leds[i];
+      nscale8(expected, count, amount);
+      ColorKernels::scale(leds, count, amount);
+      if (!same(count)) {
+        printf("scale of %u leds by %u\n", count, amount);
+        CHECK(false);
+      }
+
+      randomize();
+      for (uint16_t i = 0; i < count; i++)
+        expected[i] = leds[i];
+      fadeToBlackBy(expected, count, amount);
+      ColorKernels::fade(leds, count, amount);
+      if (!same(count)) {
+        printf("fade of %u leds by %u\n", count, amount);
+        CHECK(false);
+      }
+    }
+
+    randomize();
+    for (uint16_t i = 0; i < count; i++)
+      expected[i] = leds[i] + other[i];
+    ColorKernels::add(leds, other, count);
+    if (!same(count)) {
+      printf("add of %u leds\n", count);
+      CHECK(false);
+    }
+  }
+
+  return failures;
+}
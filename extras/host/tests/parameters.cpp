@@ -0,0 +1,28 @@
+// Parameters are found by name through the index of their table as by a scan of it, for every effect
+#include "test.h"
+
+BaseEffect* effects[] = {
+  new RainbowEffect("rainbow"),
+  new SolidEffect("solid"),
+  new TwinkleEffect<90>("twinkle"),
+  new ApplauseEffect("applause"),
+  new JuggleEffect("juggle"),
+  new FireEffect<90>("fire"),
+  new PaletteEffect("palette", "lava")
+};
+const uint8_t effectCount = sizeof(effects) / sizeof(effects[0]);
+
+int main() {
+  for (uint8_t i = 0; i < effectCount; i++) {
+    const ParameterTable& table = effects[i]->parameters();
+    for (uint8_t number = 1; number <= table.size(); number++) {
+      const Parameter* parameter = table.at(number);
+      CHECK_EQUAL(number, table.number(parameter->name));
+      CHECK(table.find(parameter->name) == parameter);
+    }
+    CHECK_EQUAL(0, table.number("unknown"));
+    CHECK(table.find("unknown") == 0);
+    CHECK_EQUAL(0, table.number(""));
+  }
+  return failures;
+}
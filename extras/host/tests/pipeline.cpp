@@ -0,0 +1,95 @@
+// A ThreadedSink with a front buffer outputs a frame while the next one renders: frames are shown whole and in
+// order, faster than with a serial render and output
+#include "test.h"
+
+#define LEDS 300
+#define FRAMES 40
+#define RENDER_MICROS 2000
+#define WIRE_MICROS 3000
+
+// Every led set to the frame number, rendering for RENDER_MICROS
+class CounterEffect : public BaseEffect
+{
+public:
+  CounterEffect() : BaseEffect("counter") { };
+
+  void loop() override {
+    _frame++;
+    fill_solid(_leds, _size, CRGB(_frame, _frame, _frame));
+    delayMicroseconds(RENDER_MICROS);
+  }
+
+private:
+  uint8_t _frame = 0;
+};
+
+// Takes WIRE_MICROS to output a frame, checking that it does not change meanwhile
+class CheckingSink : public OutputSink
+{
+public:
+  uint32_t frames = 0;
+  uint32_t torn = 0;
+  uint32_t unordered = 0;
+
+  void show(const CRGB* leds, uint16_t size, uint8_t /*brightness*/) override {
+    CRGB first = leds[0];
+    delayMicroseconds(WIRE_MICROS);
+    for (uint16_t i = 0; i < size; i++) {
+      if (leds[i] != first) {
+        torn++;
+        break;
+      }
+    }
+    if (frames > 0 && first.r != (uint8_t)(_last + 1))
+      unordered++;
+    _last = first.r;
+    frames++;
+  }
+
+private:
+  uint8_t _last = 0;
+};
+
+CRGB leds[LEDS];
+CRGB front[LEDS];
+
+// µs per frame of FRAMES frames
+uint32_t run(OutputSink* sink, CRGB* frontBuffer) {
+  BaseEffect* effects[] = { new CounterEffect() };
+  LedEffect strip(effects, 1);
+  strip.blocking = false;
+  strip.fps = 0;
+  strip.skipStaticFrames = false;
+  strip.begin(sink, leds, LEDS, frontBuffer);
+
+  uint32_t start = micros();
+  for (uint16_t i = 0; i < FRAMES; i++)
+    strip.loop();
+  while (!sink->ready()) { }
+  uint32_t elapsed = micros() - start;
+  delete effects[0];
+  return elapsed / FRAMES;
+}
+
+int main() {
+  CheckingSink serialSink;
+  uint32_t serial = run(&serialSink, 0);
+
+  CheckingSink pipelinedSink;
+  uint32_t pipelined;
+  {
+    ThreadedSink threadedSink(&pipelinedSink);
+    threadedSink.begin();
+    pipelined = run(&threadedSink, front);
+  }
+
+  printf("serial %u us/frame, pipelined %u us/frame\n", serial, pipelined);
+  CHECK_EQUAL((uint32_t)FRAMES, serialSink.frames);
+  CHECK_EQUAL((uint32_t)FRAMES, pipelinedSink.frames);
+  CHECK_EQUAL(0u, pipelinedSink.torn);
+  CHECK_EQUAL(0u, pipelinedSink.unordered);
+  CHECK(serial >= RENDER_MICROS + WIRE_MICROS);
+  CHECK(pipelined < serial * 4 / 5);  // close to max(render, wire) instead of render + wire
+
+  return failures;
+}
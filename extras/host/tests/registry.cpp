@@ -0,0 +1,31 @@
+// Effects of a registry are sized again for the leds of every begin
+#include "test.h"
+#include "../headless.h"
+
+const EffectFactory factories[] = {
+  makeEffectFactory<RainbowEffect>("rainbow"),
+  makeEffectFactory<FireEffect<90>>("fire")
+};
+EffectRegistry registry(factories, 2);
+
+CRGB leds[90];
+
+int main() {
+  MemoryPrint print;
+  FrameRecorder recorder(print);
+  LedEffect strip(registry);
+
+  // the heat of the fire takes a byte per led
+  strip.begin(&recorder, leds, 30);
+  CHECK_EQUAL((size_t)30, registry.scratchSize());
+  strip.begin(&recorder, leds, 90);
+  CHECK_EQUAL((size_t)90, registry.scratchSize());
+
+  // and the fire renders on the whole strip
+  CHECK(command(strip, "{\"brightness\":255,\"effect\":{\"name\":\"fire\",\"sparking\":255,\"forward\":false}}"));
+  for (uint32_t i = 0; i < 30; i++)
+    strip.step(i * 1000000UL / 30);
+  CHECK(leds[89] != CRGB(CRGB::Black));
+  CHECK_EQUAL(1, registry.find("fire"));
+  return failures;
+}
@@ -0,0 +1,34 @@
+// The blocking loop() waits for the next frame without showing the leds again when the output stage is set, as
+// FastLED's delay would show them raw at the global brightness
+#include "test.h"
+
+CRGB leds[90];
+BaseEffect* effects[] = {
+  new RainbowEffect("rainbow")
+};
+
+int main() {
+  LedEffect strip(effects, 1);
+  TestController controller;
+  controller.setLeds(leds, 90);
+  hostFreezeTime(1000000);
+  strip.brightness = 50;
+  strip.brightnessRate = 255;
+  strip.begin(&controller);
+
+  // FastLED shows the leds over and over while waiting, for its dithering
+  strip.loop();
+  CHECK(controller.shows > 1);
+  CHECK_EQUAL(50, controller.brightness);
+
+  // the output stage has applied the brightness, only its buffer is shown
+  strip.outputStage = true;
+  strip.invalidate();
+  for (uint8_t frame = 0; frame < 3; frame++) {
+    controller.shows = 0;
+    strip.loop();
+    CHECK_EQUAL(1u, controller.shows);
+    CHECK_EQUAL(255, controller.brightness);
+  }
+  return failures;
+}
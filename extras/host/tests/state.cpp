@@ -0,0 +1,55 @@
+// The state streamed by printTo() is the JSON of serialize(JsonObject&), for every effect
+#include "test.h"
+
+class CustomEffect : public BaseEffect
+{
+public:
+  CustomEffect() : BaseEffect("custom", 2 * JSON_NODE_SIZE) { };
+
+  void serialize(JsonObject& data) const override {
+    data["count"] = 1;
+    data["quote"] = "a \"b\"\n";
+  }
+};
+
+CRGB leds[90];
+BaseEffect* effects[] = {
+  new RainbowEffect("rainbow"),
+  new SolidEffect("solid"),
+  new TwinkleEffect<90>("twinkle"),
+  new ApplauseEffect("applause"),
+  new JuggleEffect("juggle"),
+  new FireEffect<90>("fire"),
+  new PaletteEffect("palette", "lava"),
+  new CustomEffect()
+};
+const uint8_t effectCount = sizeof(effects) / sizeof(effects[0]);
+LedEffect strip(effects, effectCount);
+
+int main() {
+  TestController controller;
+  controller.setLeds(leds, 90);
+  strip.begin(&controller);
+
+  for (uint8_t i = 0; i < effectCount; i++) {
+    char json[64];
+    snprintf(json, sizeof(json), "{\"effect\":{\"name\":\"%s\"}}", effects[i]->name);
+    CHECK(strip.deserialize(json));
+
+    DynamicJsonBuffer jsonBuffer;
+    JsonObject& root = jsonBuffer.createObject();
+    strip.serialize(root);
+    String dom;
+    root.printTo(dom);
+    CHECK_EQUAL(dom, state(strip));
+    CHECK(strstr(dom.c_str(), effects[i]->name));
+
+    // truncated the same way
+    char streamed[40];
+    char printed[40];
+    CHECK_EQUAL(root.printTo(printed, sizeof(printed)), strip.printTo(streamed, sizeof(streamed)));
+    CHECK(strcmp(printed, streamed) == 0);
+  }
+
+  return failures;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+// Checks shared by the tests, each test is a program returning the number of failed checks
+
+#include <LEDEffect.h>
+#include <string>
+
+static int failures = 0;
+
+#define CHECK(condition) \
+  do { \
+    if (!(condition)) { \
+      failures++; \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+    } \
+  } while (0)
+
+#define CHECK_EQUAL(expected, actual) \
+  do { \
+    if (!((expected) == (actual))) { \
+      failures++; \
+      printf("%s:%d: CHECK_EQUAL(%s, %s) failed\n", __FILE__, __LINE__, #expected, #actual); \
+    } \
+  } while (0)
+
+// Controller counting what is shown without outputting anything
+class TestController : public CLEDController
+{
+public:
+  uint32_t shows = 0;
+  uint8_t brightness = 0;
+
+  void init() override { }
+
+protected:
+  void showColor(const CRGB& /*data*/, int /*nLeds*/, CRGB /*scale*/) override { }
+
+  void show(const CRGB* /*data*/, int /*nLeds*/, CRGB scale) override {
+    shows++;
+    brightness = scale.r;
+  }
+};
+
+inline std::string state(LedEffect& strip) {
+  String state;
+  strip.printTo(state);
+  return state;
+}
+
+// apply a JSON command given as a constant, deserialize() parses it in place
+inline bool command(LedEffect& strip, const char* json) {
+  std::string copy(json);
+  return strip.deserialize(&copy[0]);
+}
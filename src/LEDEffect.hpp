@@ -1,6 +1,7 @@
 #pragma once
 
 #include "LEDEffect/LEDEffect.hpp"
+#include "LEDEffect/LedEffectGroup.hpp"
 #include "LEDEffect/Effects/ApplauseEffect.hpp"
 #include "LEDEffect/Effects/FireEffect.hpp"
 #include "LEDEffect/Effects/JuggleEffect.hpp"
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+// Reads the values of a binary command, little-endian, without copying the command
+//
+// Values are only assigned when they are complete, reading past the end of the command flags it as failed.
+class BinaryReader
+{
+public:
+  BinaryReader(const uint8_t* data, size_t size) : _data(data), _size(size) { };
+
+  bool read(uint8_t& value) {
+    if (!require(1))
+      return false;
+    value = _data[_position++];
+    return true;
+  }
+
+  bool read(int8_t& value) {
+    if (!require(1))
+      return false;
+    value = (int8_t)_data[_position++];
+    return true;
+  }
+
+  // 1 byte, 0 is false
+  bool read(bool& value) {
+    if (!require(1))
+      return false;
+    value = _data[_position++] != 0;
+    return true;
+  }
+
+  bool read(uint16_t& value) {
+    if (!require(2))
+      return false;
+    value = _data[_position] | ((uint16_t)_data[_position + 1] << 8);
+    _position += 2;
+    return true;
+  }
+
+  // 3 bytes: red, green, blue
+  bool read(CRGB& value) {
+    if (!require(3))
+      return false;
+    value = CRGB(_data[_position], _data[_position + 1], _data[_position + 2]);
+    _position += 3;
+    return true;
+  }
+
+  // 3 bytes: hue, saturation, value
+  bool read(CHSV& value) {
+    if (!require(3))
+      return false;
+    value = CHSV(_data[_position], _data[_position + 1], _data[_position + 2]);
+    _position += 3;
+    return true;
+  }
+
+  // a length byte followed by the characters, copied null-terminated to buffer, fails if they do not fit
+  bool read(char* buffer, size_t bufferSize) {
+    if (!require(1) || _data[_position] >= bufferSize || !require(1 + _data[_position])) {
+      _failed = true;
+      return false;
+    }
+    uint8_t length = _data[_position++];
+    memcpy(buffer, _data + _position, length);
+    buffer[length] = '\0';
+    _position += length;
+    return true;
+  }
+
+  // flag the command as failed, e.g. for an unknown id
+  void fail() {
+    _failed = true;
+  }
+
+  // whether there are values left to read
+  bool available() const {
+    return !_failed && _position < _size;
+  }
+
+  bool failed() const {
+    return _failed;
+  }
+
+private:
+  const uint8_t* _data;
+  size_t _size;
+  size_t _position = 0;
+  bool _failed = false;
+
+  bool require(size_t count) {
+    if (_failed || _size - _position < count) {
+      _failed = true;
+      return false;
+    }
+    return true;
+  }
+};
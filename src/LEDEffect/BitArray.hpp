@@ -0,0 +1,51 @@
+#pragma once
+
+#include <Arduino.h>
+
+// One bit per led packed in 32 bits words, e.g. for per-led flags of an effect, over memory it does not own
+class BitArray
+{
+public:
+  static const uint8_t WORD_BITS = 32;
+
+  // number of words holding size bits
+  static constexpr size_t wordCount(size_t size) {
+    return (size + WORD_BITS - 1) / WORD_BITS;
+  }
+
+  BitArray(uint32_t* words, size_t size) : _words(words), _size(size) { };
+
+  bool get(size_t index) const {
+    return _words[index / WORD_BITS] & mask(index);
+  }
+
+  void set(size_t index) {
+    _words[index / WORD_BITS] |= mask(index);
+  }
+
+  void clear(size_t index) {
+    _words[index / WORD_BITS] &= ~mask(index);
+  }
+
+  // clear every bit
+  void reset() {
+    memset(_words, 0, wordCount(_size) * sizeof(uint32_t));
+  }
+
+  // bits index * WORD_BITS to (index + 1) * WORD_BITS - 1, lowest bit first
+  uint32_t word(size_t index) const {
+    return _words[index];
+  }
+
+  size_t size() const {
+    return _size;
+  }
+
+protected:
+  uint32_t* _words;
+  size_t _size;
+
+  static uint32_t mask(size_t index) {
+    return (uint32_t)1 << (index % WORD_BITS);
+  }
+};
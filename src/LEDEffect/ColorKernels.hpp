@@ -0,0 +1,193 @@
+#pragma once
+
+#include <FastLED.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// Whole buffer color operations giving the same results as FastLED's per led ones
+//
+// Leds are processed as a run of channels, 16 at a time with SSE2 or NEON when built for a host
+// and 4 at a time in a 32 bits word (SWAR) otherwise, the remaining channels one at a time.
+class ColorKernels
+{
+public:
+  // nscale8(leds, count, scale)
+  static void scale(CRGB* leds, uint16_t count, uint8_t scale) {
+    uint8_t* channels = (uint8_t*)leds;
+    const size_t size = count * sizeof(CRGB);
+    const uint16_t multiplier = scaleMultiplier(scale);
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i factor = _mm_set1_epi16(multiplier);
+    for (; i + 16 <= size; i += 16) {
+      __m128i v = _mm_loadu_si128((const __m128i*)(channels + i));
+      __m128i low = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(v, zero), factor), 8);
+      __m128i high = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(v, zero), factor), 8);
+      _mm_storeu_si128((__m128i*)(channels + i), _mm_packus_epi16(low, high));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 16 <= size; i += 16) {
+      uint8x16_t v = vld1q_u8(channels + i);
+      vst1q_u8(channels + i, scaleVector(v, multiplier));
+    }
+#endif
+
+    for (; i + 4 <= size; i += 4) {
+      uint32_t word;
+      memcpy(&word, channels + i, 4);
+      word = scaleWord(word, multiplier);
+      memcpy(channels + i, &word, 4);
+    }
+
+    for (; i < size; i++) {
+      channels[i] = (channels[i] * multiplier) >> 8;
+    }
+  }
+
+  // fadeToBlackBy(leds, count, amount)
+  static void fade(CRGB* leds, uint16_t count, uint8_t amount) {
+    scale(leds, count, 255 - amount);
+  }
+
+  // leds[i] += other[i]
+  static void add(CRGB* leds, const CRGB* other, uint16_t count) {
+    uint8_t* channels = (uint8_t*)leds;
+    const uint8_t* otherChannels = (const uint8_t*)other;
+    const size_t size = count * sizeof(CRGB);
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    for (; i + 16 <= size; i += 16) {
+      __m128i a = _mm_loadu_si128((const __m128i*)(channels + i));
+      __m128i b = _mm_loadu_si128((const __m128i*)(otherChannels + i));
+      _mm_storeu_si128((__m128i*)(channels + i), _mm_adds_epu8(a, b));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 16 <= size; i += 16) {
+      vst1q_u8(channels + i, vqaddq_u8(vld1q_u8(channels + i), vld1q_u8(otherChannels + i)));
+    }
+#endif
+
+    for (; i + 4 <= size; i += 4) {
+      uint32_t a, b;
+      memcpy(&a, channels + i, 4);
+      memcpy(&b, otherChannels + i, 4);
+      a = addWord(a, b);
+      memcpy(channels + i, &a, 4);
+    }
+
+    for (; i < size; i++) {
+      channels[i] = qadd8(channels[i], otherChannels[i]);
+    }
+  }
+
+  // nblend(leds[i], other[i], amount)
+  static void blend(CRGB* leds, const CRGB* other, uint16_t count, fract8 amount) {
+    if (amount == 0)
+      return;
+    if (amount == 255) {
+      memmove(leds, other, count * sizeof(CRGB));
+      return;
+    }
+
+#if FASTLED_BLEND_FIXED == 1
+    // blend8(a, b, amount) is ((a << 8 | b) + b * amount - a * amount) >> 8, that is
+    // (a * (256 - amount) + b * (amount + 1)) >> 8 where both factors fit in 8 bits and the sum in 16 bits
+    uint8_t* channels = (uint8_t*)leds;
+    const uint8_t* otherChannels = (const uint8_t*)other;
+    const size_t size = count * sizeof(CRGB);
+    const uint16_t keepMultiplier = 256 - amount;
+    const uint16_t overlayMultiplier = amount + 1;
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i keepFactor = _mm_set1_epi16(keepMultiplier);
+    const __m128i overlayFactor = _mm_set1_epi16(overlayMultiplier);
+    for (; i + 16 <= size; i += 16) {
+      __m128i a = _mm_loadu_si128((const __m128i*)(channels + i));
+      __m128i b = _mm_loadu_si128((const __m128i*)(otherChannels + i));
+      __m128i low = _mm_srli_epi16(_mm_add_epi16(
+        _mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), keepFactor),
+        _mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), overlayFactor)), 8);
+      __m128i high = _mm_srli_epi16(_mm_add_epi16(
+        _mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), keepFactor),
+        _mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), overlayFactor)), 8);
+      _mm_storeu_si128((__m128i*)(channels + i), _mm_packus_epi16(low, high));
+    }
+#elif defined(__ARM_NEON)
+    const uint8x8_t keepFactor = vdup_n_u8(keepMultiplier);
+    const uint8x8_t overlayFactor = vdup_n_u8(overlayMultiplier);
+    for (; i + 16 <= size; i += 16) {
+      uint8x16_t a = vld1q_u8(channels + i);
+      uint8x16_t b = vld1q_u8(otherChannels + i);
+      uint16x8_t low = vmlal_u8(vmull_u8(vget_low_u8(a), keepFactor), vget_low_u8(b), overlayFactor);
+      uint16x8_t high = vmlal_u8(vmull_u8(vget_high_u8(a), keepFactor), vget_high_u8(b), overlayFactor);
+      vst1q_u8(channels + i, vcombine_u8(vshrn_n_u16(low, 8), vshrn_n_u16(high, 8)));
+    }
+#endif
+
+    for (; i + 4 <= size; i += 4) {
+      uint32_t a, b;
+      memcpy(&a, channels + i, 4);
+      memcpy(&b, otherChannels + i, 4);
+      a = blendWord(a, b, keepMultiplier, overlayMultiplier);
+      memcpy(channels + i, &a, 4);
+    }
+
+    for (; i < size; i++) {
+      channels[i] = (channels[i] * keepMultiplier + otherChannels[i] * overlayMultiplier) >> 8;
+    }
+#else
+    for (uint16_t i = 0; i < count; i++) {
+      nblend(leds[i], other[i], amount);
+    }
+#endif
+  }
+
+private:
+  // scale8(i, scale) is (i * scaleMultiplier(scale)) >> 8
+  static uint16_t scaleMultiplier(uint8_t scale) {
+#if FASTLED_SCALE8_FIXED == 1
+    return scale + 1;
+#else
+    return scale;
+#endif
+  }
+
+  // scale the 4 channels of a word, even and odd channels in 16 bits lanes which cannot overflow
+  static uint32_t scaleWord(uint32_t word, uint16_t multiplier) {
+    uint32_t even = (((word & 0x00FF00FF) * multiplier) >> 8) & 0x00FF00FF;
+    uint32_t odd = (((word >> 8) & 0x00FF00FF) * multiplier) & 0xFF00FF00;
+    return even | odd;
+  }
+
+  // blend the 4 channels of two words, the sum of both products of a 16 bits lane never exceeds 16 bits
+  static uint32_t blendWord(uint32_t a, uint32_t b, uint16_t keepMultiplier, uint16_t overlayMultiplier) {
+    uint32_t even = (a & 0x00FF00FF) * keepMultiplier + (b & 0x00FF00FF) * overlayMultiplier;
+    uint32_t odd = ((a >> 8) & 0x00FF00FF) * keepMultiplier + ((b >> 8) & 0x00FF00FF) * overlayMultiplier;
+    return ((even >> 8) & 0x00FF00FF) | (odd & 0xFF00FF00);
+  }
+
+  // saturating add of the 4 channels of a word
+  static uint32_t addWord(uint32_t a, uint32_t b) {
+    uint32_t sum = (a & 0x7F7F7F7F) + (b & 0x7F7F7F7F);  // low 7 bits, carrying into bit 7
+    uint32_t carry = ((a & b) | (sum & (a ^ b))) & 0x80808080;  // carry out of bit 7
+    sum ^= (a ^ b) & 0x80808080;
+    return sum | ((carry >> 7) * 0xFF);
+  }
+
+#if defined(__ARM_NEON) && !defined(__SSE2__)
+  static uint8x16_t scaleVector(uint8x16_t v, uint16_t multiplier) {
+    uint16x8_t low = vshrq_n_u16(vmulq_n_u16(vmovl_u8(vget_low_u8(v)), multiplier), 8);
+    uint16x8_t high = vshrq_n_u16(vmulq_n_u16(vmovl_u8(vget_high_u8(v)), multiplier), 8);
+    return vcombine_u8(vmovn_u16(low), vmovn_u16(high));
+  }
+#endif
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Bytes of fields a CommandStage holds, each taking 2 bytes more than in a binary command
+#ifndef LEDEFFECT_STAGE_SIZE
+#define LEDEFFECT_STAGE_SIZE 64
+#endif
+
+// Fields of binary commands staged to be applied at once, see LedEffect::queue()
+//
+// Staging a field replaces the value staged before for the same field, so that a burst of commands is applied as a
+// single command holding the last value of each field. Fields are kept as a key, the size of the value and the
+// value, the key of a field of the effect being its id + EFFECT_FIELD.
+class CommandStage
+{
+public:
+  static const uint8_t EFFECT_FIELD = 0x80;
+  static const uint8_t EFFECT_ID = 5;  // id of the effect field, followed by the index and the fields of the effect
+
+  // stage a field with its value, return false if there is no room left
+  bool set(uint8_t key, const uint8_t* value, uint8_t size) {
+    remove(key);
+    if (_size + 2 + size > LEDEFFECT_STAGE_SIZE)
+      return false;
+
+    _data[_size++] = key;
+    _data[_size++] = size;
+    memcpy(_data + _size, value, size);
+    _size += size;
+    return true;
+  }
+
+  // stage fields of the effect at index, dropping the ones staged for another effect
+  void setEffect(uint8_t index) {
+    if (index == _effect)
+      return;
+    for (uint8_t position = 0; position < _size;) {
+      if (_data[position] & EFFECT_FIELD)
+        erase(position);
+      else
+        position += 2 + _data[position + 1];
+    }
+    _effect = index;
+  }
+
+  // write the staged fields as a binary command into command of LEDEFFECT_STAGE_SIZE + 1 bytes, the fields of the
+  // effect after its index if there are any, return its size
+  size_t command(uint8_t* command) const {
+    size_t size = 0;
+    bool effect = false;
+    for (uint8_t pass = 0; pass < 2; pass++) {
+      for (uint8_t position = 0; position < _size; position += 2 + _data[position + 1]) {
+        uint8_t key = _data[position];
+        if ((key & EFFECT_FIELD) != (pass ? EFFECT_FIELD : 0))
+          continue;
+        if (pass && !effect) {
+          command[size++] = EFFECT_ID;
+          command[size++] = _effect;
+          effect = true;
+        }
+        command[size++] = key & ~EFFECT_FIELD;
+        memcpy(command + size, _data + position + 2, _data[position + 1]);
+        size += _data[position + 1];
+      }
+    }
+    return size;
+  }
+
+  bool empty() const {
+    return _size == 0;
+  }
+
+  void clear() {
+    _size = 0;
+  }
+
+private:
+  uint8_t _data[LEDEFFECT_STAGE_SIZE];
+  uint8_t _size = 0;
+  uint8_t _effect = 0;
+
+  void remove(uint8_t key) {
+    for (uint8_t position = 0; position < _size; position += 2 + _data[position + 1]) {
+      if (_data[position] == key) {
+        erase(position);
+        return;
+      }
+    }
+  }
+
+  void erase(uint8_t position) {
+    uint8_t size = 2 + _data[position + 1];
+    memmove(_data + position, _data + position + size, _size - position - size);
+    _size -= size;
+  }
+};
@@ -2,6 +2,14 @@
 
 //#define LEDEFFECT_DEBUG
 
+// Expand palettes to 256 colors tables for faster rendering at the cost of 768 bytes per palette
+//#define LEDEFFECT_PALETTE_TABLE
+
+// Allocate the JSON buffer once in begin() and reuse it instead of allocating on every (de)serialization,
+// commands that do not fit in the computed buffer size are rejected. The segments of a LedEffectGroup share the
+// buffer of the group, one is only allocated for a segment given a command directly.
+//#define LEDEFFECT_JSON_ARENA
+
 #ifndef ARDUINO
 #define max(a,b) ((a)>(b)?(a):(b))
 #define min(a,b) ((a)<(b)?(a):(b))
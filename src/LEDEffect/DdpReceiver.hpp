@@ -0,0 +1,102 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <Udp.h>
+
+#include "Configuration.hpp"
+#include "DdpSink.hpp"
+
+// Receiver of DDP frames over UDP, read straight into the leds, see LedEffect::ingest()
+//
+// The data of each packet is read from the UDP buffer into the leds at its byte offset, without a buffer of its own.
+// A frame is complete on a packet with the push flag, or for senders that never push, on a packet that reaches the
+// last led. Reading stops after a complete frame so that it is shown before the next one overwrites it.
+class DdpReceiver
+{
+public:
+  DdpReceiver(UDP& udp) : _udp(udp) { };
+
+  // listen on port
+  bool begin(uint16_t port = LEDEFFECT_DDP_PORT) {
+    return _udp.begin(port);
+  }
+
+  // read the packets received into size leds, or skip their data when leds is 0, return whether a frame is complete
+  bool receive(CRGB* leds, uint16_t size) {
+    uint8_t header[LEDEFFECT_DDP_HEADER_SIZE];
+    while (_udp.parsePacket() > 0) {
+      if (_udp.read(header, sizeof(header)) != sizeof(header) || (header[0] & 0xC0) != 0x40) {
+        _errors++;
+        continue;
+      }
+      // queries, replies and other data types than 8 bits RGB (or undefined) are not for us
+      if (header[0] & 0x06 || (header[2] != 0 && header[2] != 0x0B) || (header[3] != 1 && header[3] != 255)) {
+        _errors++;
+        continue;
+      }
+      if (header[0] & 0x10) {
+        // timecode, ignored
+        uint8_t timecode[4];
+        if (_udp.read(timecode, sizeof(timecode)) != sizeof(timecode)) {
+          _errors++;
+          continue;
+        }
+      }
+
+      uint8_t sequence = header[1] & 0x0F;
+      if (sequence && _sequence && sequence != _sequence % 15 + 1)
+        _lost++;
+      _sequence = sequence;
+      _packets++;
+
+      uint32_t offset = (uint32_t)header[4] << 24 | (uint32_t)header[5] << 16 | header[6] << 8 | header[7];
+      uint16_t length = header[8] << 8 | header[9];
+      uint32_t end = (uint32_t)size * sizeof(CRGB);
+      bool last = false;
+      if (offset < end) {
+        uint16_t count = min((uint32_t)length, end - offset);
+        if (leds && _udp.read((uint8_t*)leds + offset, count) != count)
+          _errors++;
+        last = offset + length >= end;
+      }
+
+      bool push = header[0] & 0x01;
+      _pushes |= push;
+      if (push || (!_pushes && last)) {
+        _frames++;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // frames completed
+  uint32_t frames() const {
+    return _frames;
+  }
+
+  // packets read
+  uint32_t packets() const {
+    return _packets;
+  }
+
+  // packets missing from the sequence numbers
+  uint32_t lost() const {
+    return _lost;
+  }
+
+  // packets invalid, truncated or not for us
+  uint32_t errors() const {
+    return _errors;
+  }
+
+protected:
+  UDP& _udp;
+  uint8_t _sequence = 0;
+  bool _pushes = false;  // whether the sender pushes its frames
+  uint32_t _frames = 0;
+  uint32_t _packets = 0;
+  uint32_t _lost = 0;
+  uint32_t _errors = 0;
+};
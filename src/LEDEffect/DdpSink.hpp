@@ -0,0 +1,145 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <IPAddress.h>
+#include <Udp.h>
+
+#include "ColorKernels.hpp"
+#include "Configuration.hpp"
+#include "OutputSink.hpp"
+
+// Leds per DDP packet, 480 leds are 1440 bytes which fit in an Ethernet frame with the headers
+#ifndef LEDEFFECT_DDP_PACKET_LEDS
+#define LEDEFFECT_DDP_PACKET_LEDS 480
+#endif
+
+#define LEDEFFECT_DDP_PORT 4048
+#define LEDEFFECT_DDP_HEADER_SIZE 10
+
+// Output to a DDP (Distributed Display Protocol) receiver over UDP, e.g. a WLED or ESPixelStick node
+//
+// A frame is split in packets of LEDEFFECT_DDP_PACKET_LEDS leds at their byte offset, the last packet of the frame
+// flagged to push it to the leds. Packets whose leds did not change since the previous frame are skipped, except
+// every keyframeInterval frames so that receivers which lost a packet or restarted catch up. Brightness is applied
+// to the leds sent.
+class DdpSink : public OutputSink
+{
+public:
+  uint16_t keyframeInterval = 30;  // frames between frames sent whole, 0 to always send them whole
+
+  DdpSink(UDP& udp, IPAddress address, uint16_t port = LEDEFFECT_DDP_PORT) :
+    _udp(udp), _address(address), _port(port) { };
+
+  ~DdpSink() {
+    free(_previous);
+  }
+
+  void show(const CRGB* leds, uint16_t size, uint8_t brightness) override {
+    _packets = 0;
+    _bytes = 0;
+
+    bool keyframe = keyframeInterval == 0 || _frames % keyframeInterval == 0;
+    if (size != _size) {
+      free(_previous);
+      _previous = (uint8_t*)malloc(size * sizeof(CRGB));
+      _size = _previous ? size : 0;
+      keyframe = true;
+      if (!_previous) {
+        LEDEFFECT_DEBUG_PRINTLN(F("DdpSink: Out of memory"));
+        return;
+      }
+    }
+    _frames++;
+
+    // the last packet to send carries the push flag
+    uint16_t packetCount = (size + LEDEFFECT_DDP_PACKET_LEDS - 1) / LEDEFFECT_DDP_PACKET_LEDS;
+    int32_t last = packetCount - 1;
+    if (!keyframe) {
+      while (last >= 0 && !changed(leds, size, brightness, last))
+        last--;
+    }
+
+    for (int32_t packet = 0; packet <= last; packet++) {
+      uint16_t start = packet * LEDEFFECT_DDP_PACKET_LEDS;
+      uint16_t count = min((uint16_t)(size - start), (uint16_t)LEDEFFECT_DDP_PACKET_LEDS);
+      uint32_t offset = start * sizeof(CRGB);
+      uint16_t length = count * sizeof(CRGB);
+
+      uint8_t* data = _packet + LEDEFFECT_DDP_HEADER_SIZE;
+      memcpy(data, &leds[start], length);
+      if (brightness < 255)
+        ColorKernels::scale((CRGB*)data, count, brightness);
+      if (!keyframe && packet < last && memcmp(data, _previous + offset, length) == 0)
+        continue;
+
+      _sequence = _sequence % 15 + 1;
+      _packet[0] = 0x40 | (packet == last ? 0x01 : 0);  // version 1, push
+      _packet[1] = _sequence;
+      _packet[2] = 0x0B;  // RGB, 8 bits per channel
+      _packet[3] = 1;     // default output device
+      _packet[4] = offset >> 24;
+      _packet[5] = offset >> 16;
+      _packet[6] = offset >> 8;
+      _packet[7] = offset;
+      _packet[8] = length >> 8;
+      _packet[9] = length;
+      size_t packetSize = LEDEFFECT_DDP_HEADER_SIZE + length;
+      if (!_udp.beginPacket(_address, _port) || _udp.write(_packet, packetSize) != packetSize || !_udp.endPacket()) {
+        LEDEFFECT_DEBUG_PRINTLN(F("DdpSink: Failed to send a packet"));
+        _failures++;
+        continue;
+      }
+      // only leds that were sent are skipped next time, a packet that failed is sent again with the next frame
+      memcpy(_previous + offset, data, length);
+      _packets++;
+      _bytes += packetSize;
+    }
+  }
+
+  uint16_t packets() const override {
+    return _packets;
+  }
+
+  uint32_t bytes() const override {
+    return _bytes;
+  }
+
+  // frames shown
+  uint32_t frames() const {
+    return _frames;
+  }
+
+  // packets that could not be sent
+  uint32_t failures() const {
+    return _failures;
+  }
+
+protected:
+  UDP& _udp;
+  IPAddress _address;
+  uint16_t _port;
+  uint8_t* _previous = 0;  // leds sent last, brightness applied
+  uint16_t _size = 0;
+  uint8_t _packet[LEDEFFECT_DDP_HEADER_SIZE + LEDEFFECT_DDP_PACKET_LEDS * sizeof(CRGB)];
+  uint8_t _sequence = 0;
+  uint32_t _frames = 0;
+  uint16_t _packets = 0;
+  uint32_t _bytes = 0;
+  uint32_t _failures = 0;
+
+  // whether the leds of packet differ from the ones sent last
+  bool changed(const CRGB* leds, uint16_t size, uint8_t brightness, uint16_t packet) const {
+    uint16_t start = packet * LEDEFFECT_DDP_PACKET_LEDS;
+    uint16_t end = min(size, (uint16_t)(start + LEDEFFECT_DDP_PACKET_LEDS));
+    const CRGB* previous = (const CRGB*)_previous;
+    for (uint16_t i = start; i < end; i++) {
+      CRGB led = leds[i];
+      if (brightness < 255)
+        led.nscale8(brightness);
+      if (led != previous[i])
+        return true;
+    }
+    return false;
+  }
+};
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <Arduino.h>
+#include <new>
+
+#include "Configuration.hpp"
+#include "Parameter.hpp"
+#include "Effects/BaseEffect.hpp"
+
+// Constructs an effect named name in memory
+typedef BaseEffect* (*EffectConstructor)(void* memory, const char* name);
+
+// How to construct an effect, see makeEffectFactory() for effects constructed with their default settings
+struct EffectFactory
+{
+  const char* name;
+  size_t size;  // sizeof the effect
+  EffectConstructor construct;
+};
+
+template<class E>
+BaseEffect* constructEffect(void* memory, const char* name) {
+  return new (memory) E(name);
+}
+
+template<class E>
+EffectFactory makeEffectFactory(const char* name) {
+  return EffectFactory { name, sizeof(E), constructEffect<E> };
+}
+
+// Effects constructed on selection, only the selected one lives in memory
+//
+// The selected effect is constructed in a block sized for the largest effect, allocated by the first begin() and
+// reused on every switch, so the memory used is that of the largest effect whatever the number of effects.
+// Settings of an effect are lost when switching to another one. Names are looked up in a hash table.
+class EffectRegistry
+{
+public:
+  EffectRegistry(const EffectFactory* factories, uint8_t count) : _factories(factories), _count(count) { };
+
+  ~EffectRegistry() {
+    destroy();
+    free(_memory);
+    free(_index);
+  }
+
+  // allocate the effect memory and index the names on the first call, return false if out of memory
+  //
+  // Every effect is constructed and begun with leds to get its JSON buffer and scratch sizes, again on every call as
+  // they depend on the leds.
+  bool begin(CRGB* leds, uint16_t size) {
+    if (!_memory) {
+      size_t maxSize = 0;
+      for (uint8_t i = 0; i < _count; i++) {
+        if (_factories[i].size > maxSize)
+          maxSize = _factories[i].size;
+      }
+      _memory = malloc(maxSize);
+      LEDEFFECT_DEBUG_PRINT(F("Effect Registry: Effect memory is "));
+      LEDEFFECT_DEBUG_PRINTLN(maxSize);
+    }
+
+    if (!_index) {
+      // open addressing with linear probing, at most half full
+      _indexSize = 4;
+      while (_indexSize < 2 * _count)
+        _indexSize *= 2;
+      _index = (uint8_t*)calloc(_indexSize, 1);
+
+      for (uint8_t i = 0; _index && i < _count; i++) {
+        uint16_t slot = nameHash(_factories[i].name) & (_indexSize - 1);
+        while (_index[slot])
+          slot = (slot + 1) & (_indexSize - 1);
+        _index[slot] = i + 1;
+      }
+    }
+
+    if (!_memory || !_index) {
+      LEDEFFECT_DEBUG_PRINTLN(F("Effect Registry: Out of memory"));
+      return false;
+    }
+
+    _jsonBufferSize = 0;
+    _scratchSize = 0;
+    for (uint8_t i = 0; i < _count; i++) {
+      select(i);
+      _effect->begin(leds, size);
+      if (_effect->jsonBufferSize() > _jsonBufferSize)
+        _jsonBufferSize = _effect->jsonBufferSize();
+      if (_effect->scratchSize() > _scratchSize)
+        _scratchSize = _effect->scratchSize();
+    }
+    destroy();
+    return true;
+  }
+
+  // index of the effect named name, -1 if there is none
+  int16_t find(const char* name) const {
+    if (!_index)
+      return -1;
+
+    uint16_t slot = nameHash(name) & (_indexSize - 1);
+    while (_index[slot]) {
+      uint8_t i = _index[slot] - 1;
+      if (strcmp(_factories[i].name, name) == 0)
+        return i;
+      slot = (slot + 1) & (_indexSize - 1);
+    }
+    return -1;
+  }
+
+  // destroy the selected effect and construct the effect at index with its default settings
+  BaseEffect* select(uint8_t index) {
+    if (index >= _count || !_memory)
+      return 0;
+
+    destroy();
+    memset(_memory, 0, _factories[index].size);
+    _effect = _factories[index].construct(_memory, _factories[index].name);
+    _selected = index;
+    return _effect;
+  }
+
+  const char* name(uint8_t index) const {
+    return _factories[index].name;
+  }
+
+  BaseEffect* effect() const {
+    return _effect;
+  }
+
+  uint8_t selected() const {
+    return _selected;
+  }
+
+  uint8_t size() const {
+    return _count;
+  }
+
+  size_t jsonBufferSize() const {
+    return _jsonBufferSize;
+  }
+
+  // largest scratch memory of the effects
+  size_t scratchSize() const {
+    return _scratchSize;
+  }
+
+private:
+  const EffectFactory* _factories;
+  uint8_t _count;
+  void* _memory = 0;
+  uint8_t* _index = 0;  // effect index + 1 by hash of the name, 0 for an empty slot
+  uint16_t _indexSize = 0;
+  BaseEffect* _effect = 0;
+  uint8_t _selected = 0;
+  size_t _jsonBufferSize = 0;
+  size_t _scratchSize = 0;
+
+  void destroy() {
+    if (_effect) {
+      _effect->~BaseEffect();
+      _effect = 0;
+    }
+  }
+};
@@ -1,6 +1,11 @@
 #pragma once
 
 #include "PaletteEffect.hpp"
+#include "../ColorKernels.hpp"
+
+#ifndef LEDEFFECT_APPLAUSE_MAX_FLASHES
+#define LEDEFFECT_APPLAUSE_MAX_FLASHES 8  // flashes in a frame, when frames are far apart
+#endif
 
 // Random white flashes transforming into a color before fading to black
 class ApplauseEffect final : public PaletteEffect
@@ -10,32 +15,46 @@ public:
 
   ApplauseEffect(const char* name, uint8_t fadeRate = 32, const char* paletteName = "ocean", TBlendType blend = NOBLEND,
     const PaletteData* palettes = 0, const size_t paletteCount = 0) :
-    PaletteEffect(name, paletteName, blend, palettes, paletteCount, JSON_NODE_SIZE), fadeRate(fadeRate) { };
+    PaletteEffect(name, paletteName, blend, palettes, paletteCount), fadeRate(fadeRate) { };
+
+  const ParameterTable& parameters() const override {
+    static const Parameter parameters[] = {
+      Parameter("fade_rate", &ApplauseEffect::fadeRate)
+    };
+    static const ParameterTable table(parameters, 1, &PaletteEffect::parameters());
+    return table;
+  }
 
-  void deserialize(JsonObject& data) override {
-    PaletteEffect::deserialize(data);
+  void begin(CRGB* leds, uint16_t size) override {
+    // the flash of the last frame may be past the end of fewer leds
+    _lastPixel = 0;
+    BaseEffect::begin(leds, size);
+  }
 
-    // fadeRate
-    if (data.containsKey("fade_rate")) {
-      LEDEFFECT_DEBUG_PRINT(F("ApplauseEffect: fadeRate to "));
-      LEDEFFECT_DEBUG_PRINTLN(data["fade_rate"].as<uint8_t>());
-      fadeRate = data["fade_rate"].as<uint8_t>();
+  using BaseEffect::begin;
+
+  void loop(const FrameContext& frame) override {
+    ColorKernels::fade(_leds, _size, frame.fade(fadeRate));
+
+    // a flash per frame at LEDEFFECT_RATE_FPS
+    uint32_t flashes = frame.steps(1, _remainder);
+    for (uint32_t i = 0; i < flashes && i < LEDEFFECT_APPLAUSE_MAX_FLASHES; i++) {
+#ifdef LEDEFFECT_PALETTE_TABLE
+      _leds[_lastPixel] = _paletteTable[random8()];
+#else
+      _leds[_lastPixel] = ColorFromPalette(_palette, random8(), 255, blend);
+#endif
+      // _leds[_lastPixel] = CHSV(random8(hueStart, hueEnd), saturation, value);
+      _lastPixel = random16(_size);
+      _leds[_lastPixel] = CRGB::White;
     }
   }
 
-  void serialize(JsonObject& data) const override {
-    PaletteEffect::serialize(data);
-
-    data["fade_rate"] = fadeRate;
+  bool isStatic() const override {
+    return false;
   }
 
-  void loop() override {
-    static uint16_t lastPixel = 0;
-
-    fadeToBlackBy(_controller->leds(), _controller->size(), fadeRate);
-    _controller->leds()[lastPixel] = ColorFromPalette(PaletteFromName(paletteName), random8(), 255, blend);
-    // _controller->leds()[lastPixel] = CHSV(random8(hueStart, hueEnd), saturation, value);
-    lastPixel = random16(_controller->size());
-    _controller->leds()[lastPixel] = CRGB::White;
-  }
+protected:
+  uint16_t _lastPixel = 0;
+  uint8_t _remainder = 0;
 };
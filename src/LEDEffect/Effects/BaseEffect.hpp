@@ -2,32 +2,287 @@
 
 #include <ArduinoJson.h>
 #include <FastLED.h>
+#include "../BinaryReader.hpp"
 #include "../Configuration.hpp"
+#include "../FrameContext.hpp"
+#include "../JsonWriter.hpp"
+#include "../Parameter.hpp"
 
 #ifndef LEDEFFECT_EFFECT_NAME_MAX_LENGTH
 #define LEDEFFECT_EFFECT_NAME_MAX_LENGTH 20
 #endif
 
+// Base of the effects
+//
+// Effects declare their settings in parameters(), from which deserialize, serialize and the JSON buffer size
+// are derived. Effects with members that do not fit in a parameter override them instead and give the JSON
+// buffer size of those members to the constructor.
 class BaseEffect
 {
 public:
   char name[LEDEFFECT_EFFECT_NAME_MAX_LENGTH];
-  const size_t jsonBufferSize = 0;
 
-  BaseEffect(const char* name, const size_t jsonBufferSize = 0) : jsonBufferSize(jsonBufferSize) {
-    strncpy(this->name, name, LEDEFFECT_EFFECT_NAME_MAX_LENGTH);
+  BaseEffect(const char* name, const size_t jsonBufferSize = 0) : _jsonBufferSize(jsonBufferSize) {
+    strncpy(this->name, name, LEDEFFECT_EFFECT_NAME_MAX_LENGTH - 1);
+    this->name[LEDEFFECT_EFFECT_NAME_MAX_LENGTH - 1] = '\0';
   };
 
-  virtual void begin(CLEDController* controller) {
+  virtual ~BaseEffect() { };
+
+  // render into size leds
+  virtual void begin(CRGB* leds, uint16_t size) {
     LEDEFFECT_DEBUG_PRINT(F("BaseEffect: Beginning effect "));
     LEDEFFECT_DEBUG_PRINTLN(name);
-    _controller = controller;
+    _leds = leds;
+    _size = size;
+  }
+
+  void begin(CLEDController* controller) {
+    begin(controller->leds(), controller->size());
+  }
+
+  // bytes of working memory needed to render the leds given to begin(), lent by LedEffect while selected
+  virtual size_t scratchSize() const {
+    return 0;
+  }
+
+  // called on selection with scratchSize() bytes of zeroed working memory, valid until the next selection, or 0 if
+  // there is not enough memory in which case the effect should not render
+  virtual void activate(uint8_t* /*scratch*/) { }
+
+  virtual const ParameterTable& parameters() const {
+    static const ParameterTable table(0, 0);
+    return table;
+  }
+
+  // apply the members of data in a single pass, each looked up in parameters()
+  virtual void deserialize(JsonObject& data) {
+    const ParameterTable& table = parameters();
+    for (auto member : data) {
+      const Parameter* parameter = table.find(member.key);
+      if (parameter && set(*parameter, member.value)) {
+        LEDEFFECT_DEBUG_PRINT(F("BaseEffect: Set "));
+        LEDEFFECT_DEBUG_PRINTLN(parameter->name);
+        changed(*parameter);
+      }
+    }
+  }
+
+  // read the value of the parameter with the given id from a binary command, return false for an unknown id
+  //
+  // Parameters are numbered from 1 in the order of serialize(), see LedEffect::deserialize(const uint8_t*, size_t).
+  virtual bool deserialize(BinaryReader& reader, uint8_t id) {
+    const Parameter* parameter = parameters().at(id);
+    if (!parameter || !set(*parameter, reader))
+      return false;
+    changed(*parameter);
+    return true;
+  }
+
+  virtual void serialize(JsonObject& data) const {
+    const ParameterTable& table = parameters();
+    for (uint8_t i = 1; i <= table.size(); i++) {
+      const Parameter& parameter = *table.at(i);
+      if (parameter.readable())
+        get(parameter, data);
+    }
+  }
+
+  // stream the same members as serialize(JsonObject&), effects with parameters overriding it must override this
+  // as well, effects without parameters get them from serialize(JsonObject&) through a JSON buffer
+  virtual void serialize(JsonWriter& writer) const {
+    const ParameterTable& table = parameters();
+    if (table.size() == 0) {
+      DynamicJsonBuffer jsonBuffer(_jsonBufferSize);
+      JsonObject& data = jsonBuffer.createObject();
+      serialize(data);
+      for (auto member : data) {
+        writer.key(member.key);
+        writer.printable(member.value);
+      }
+      return;
+    }
+
+    for (uint8_t i = 1; i <= table.size(); i++) {
+      const Parameter& parameter = *table.at(i);
+      if (parameter.readable())
+        get(parameter, writer);
+    }
   }
 
-  virtual void deserialize(JsonObject& data) = 0;
-  virtual void serialize(JsonObject& data) const = 0;
-  virtual void loop() = 0;
+  // render a frame, effects animating over time override loop(const FrameContext&) instead
+  virtual void loop() { }
+
+  // render the frame at frame.now, scaling the rates of the effect to frame.elapsed
+  virtual void loop(const FrameContext& /*frame*/) {
+    loop();
+  }
+
+  // whether loop() would render the frame it rendered last, so that it can be skipped
+  virtual bool isStatic() const {
+    return false;
+  }
+
+  // largest change of a channel per frame at LEDEFFECT_RATE_FPS, 0 if static and 255 if unknown or abrupt, for
+  // LedEffect to adapt the frame rate to
+  virtual uint8_t activity() const {
+    return isStatic() ? 0 : 255;
+  }
+
+  // size of the JSON buffer for the members of the effect, in a command or serialized
+  size_t jsonBufferSize() const {
+    size_t size = _jsonBufferSize;
+    const ParameterTable& table = parameters();
+    for (uint8_t i = 1; i <= table.size(); i++) {
+      ParameterType type = table.at(i)->type;
+      size += JSON_NODE_SIZE;
+      if (type == PARAMETER_RGB || type == PARAMETER_HSV)
+        size += JSON_ARRAY_SIZE(3);
+    }
+    return size;
+  }
 
 protected:
-  CLEDController* _controller;
+  CRGB* _leds;
+  uint16_t _size;
+  const size_t _jsonBufferSize;
+
+  // called after a parameter is deserialized, e.g. to update what depends on it
+  virtual void changed(const Parameter& /*parameter*/) { }
+
+private:
+  bool set(const Parameter& parameter, const JsonVariant& value) {
+    switch (parameter.type) {
+      case PARAMETER_UINT8:
+        this->*parameter.member.uint8 = parameter.clamp(value.as<long>());
+        return true;
+      case PARAMETER_INT8:
+        this->*parameter.member.int8 = parameter.clamp(value.as<long>());
+        return true;
+      case PARAMETER_BOOL:
+        this->*parameter.member.boolean = value.as<bool>();
+        return true;
+      case PARAMETER_BLEND:
+        this->*parameter.member.blend = (TBlendType)value.as<bool>();
+        return true;
+      case PARAMETER_RGB:
+        this->*parameter.member.color = CRGB(value[0].as<uint8_t>(), value[1].as<uint8_t>(), value[2].as<uint8_t>());
+        return true;
+      case PARAMETER_HSV:
+        this->*parameter.member.color = CHSV(value[0].as<uint8_t>(), value[1].as<uint8_t>(), value[2].as<uint8_t>());
+        return true;
+      case PARAMETER_PALETTE: {
+        const char* string = value.as<const char*>();
+        if (!string)
+          return false;
+        char* palette = this->*parameter.member.palette;
+        strncpy(palette, string, LEDEFFECT_PALETTE_NAME_MAX_LENGTH - 1);
+        palette[LEDEFFECT_PALETTE_NAME_MAX_LENGTH - 1] = '\0';
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool set(const Parameter& parameter, BinaryReader& reader) {
+    switch (parameter.type) {
+      case PARAMETER_UINT8: {
+        uint8_t value;
+        if (!reader.read(value))
+          return false;
+        this->*parameter.member.uint8 = parameter.clamp(value);
+        return true;
+      }
+      case PARAMETER_INT8: {
+        int8_t value;
+        if (!reader.read(value))
+          return false;
+        this->*parameter.member.int8 = parameter.clamp(value);
+        return true;
+      }
+      case PARAMETER_BOOL:
+        return reader.read(this->*parameter.member.boolean);
+      case PARAMETER_BLEND: {
+        bool value;
+        if (!reader.read(value))
+          return false;
+        this->*parameter.member.blend = (TBlendType)value;
+        return true;
+      }
+      case PARAMETER_RGB:
+        return reader.read(this->*parameter.member.color);
+      case PARAMETER_HSV: {
+        CHSV value;
+        if (!reader.read(value))
+          return false;
+        this->*parameter.member.color = value;
+        return true;
+      }
+      case PARAMETER_PALETTE:
+        return reader.read(this->*parameter.member.palette, LEDEFFECT_PALETTE_NAME_MAX_LENGTH);
+    }
+    return false;
+  }
+
+  void get(const Parameter& parameter, JsonObject& data) const {
+    switch (parameter.type) {
+      case PARAMETER_UINT8:
+        data[parameter.name] = this->*parameter.member.uint8;
+        break;
+      case PARAMETER_INT8:
+        data[parameter.name] = this->*parameter.member.int8;
+        break;
+      case PARAMETER_BOOL:
+        data[parameter.name] = this->*parameter.member.boolean;
+        break;
+      case PARAMETER_BLEND:
+        data[parameter.name] = (bool)(this->*parameter.member.blend);
+        break;
+      case PARAMETER_RGB: {
+        const CRGB& color = this->*parameter.member.color;
+        JsonArray& array = data.createNestedArray(parameter.name);
+        array.add(color.r);
+        array.add(color.g);
+        array.add(color.b);
+        break;
+      }
+      case PARAMETER_PALETTE:
+        data[parameter.name] = (const char*)(this->*parameter.member.palette);
+        break;
+      default:
+        break;
+    }
+  }
+
+  void get(const Parameter& parameter, JsonWriter& writer) const {
+    switch (parameter.type) {
+      case PARAMETER_UINT8:
+        writer.member(parameter.name, this->*parameter.member.uint8);
+        break;
+      case PARAMETER_INT8:
+        writer.member(parameter.name, this->*parameter.member.int8);
+        break;
+      case PARAMETER_BOOL:
+        writer.member(parameter.name, this->*parameter.member.boolean);
+        break;
+      case PARAMETER_BLEND:
+        writer.member(parameter.name, (bool)(this->*parameter.member.blend));
+        break;
+      case PARAMETER_RGB: {
+        const CRGB& color = this->*parameter.member.color;
+        writer.key(parameter.name);
+        writer.beginArray();
+        writer.value(color.r);
+        writer.value(color.g);
+        writer.value(color.b);
+        writer.endArray();
+        break;
+      }
+      case PARAMETER_PALETTE:
+        writer.member(parameter.name, (const char*)(this->*parameter.member.palette));
+        break;
+      default:
+        break;
+    }
+  }
 };
@@ -1,6 +1,11 @@
 #pragma once
 
 #include "BaseEffect.hpp"
+#include "../PaletteTable.hpp"
+
+#ifndef LEDEFFECT_FIRE_MAX_STEPS
+#define LEDEFFECT_FIRE_MAX_STEPS 4  // steps of the simulation in a frame, when frames are far apart
+#endif
 
 template<size_t NUM_LEDS>
 class FireEffect : public BaseEffect
@@ -11,72 +16,116 @@ public:
   bool forward;
 
   FireEffect(const char* name, uint8_t cooling = 55, uint8_t sparking = 120, bool forward = true) :
-    BaseEffect(name, 2 * JSON_NODE_SIZE), cooling(cooling), sparking(sparking), forward(forward) { };
-
-  void deserialize(JsonObject& data) override {
-    // cooling
-    if (data.containsKey("cooling")) {
-      LEDEFFECT_DEBUG_PRINT(F("FireEffect: cooling to "));
-      LEDEFFECT_DEBUG_PRINTLN(data["cooling"].as<uint8_t>());
-      cooling = data["cooling"].as<uint8_t>();
-    }
+    BaseEffect(name), cooling(cooling), sparking(sparking), forward(forward) { };
 
-    // sparking
-    if (data.containsKey("sparking")) {
-      LEDEFFECT_DEBUG_PRINT(F("FireEffect: sparking to "));
-      LEDEFFECT_DEBUG_PRINTLN(data["sparking"].as<uint8_t>());
-      sparking = data["sparking"].as<uint8_t>();
-    }
+  const ParameterTable& parameters() const override {
+    static const Parameter parameters[] = {
+      Parameter("cooling", &FireEffect::cooling),
+      Parameter("sparking", &FireEffect::sparking),
+      Parameter("forward", &FireEffect::forward)
+    };
+    static const ParameterTable table(parameters, 3);
+    return table;
+  }
 
-    // forward
-    if (data.containsKey("forward")) {
-      LEDEFFECT_DEBUG_PRINT(F("FireEffect: forward to "));
-      LEDEFFECT_DEBUG_PRINTLN(data["forward"].as<bool>());
-      forward = data["forward"].as<bool>();
+  void begin(CRGB* leds, uint16_t size) override {
+    if (size > NUM_LEDS) {
+      LEDEFFECT_DEBUG_PRINTLN(F("FireEffect: More leds than NUM_LEDS, rendering NUM_LEDS"));
+      size = NUM_LEDS;
     }
+    BaseEffect::begin(leds, size);
   }
 
-  void serialize(JsonObject& data) const override {
-    data["cooling"] = cooling;
-    data["sparking"] = sparking;
-    data["forward"] = forward;
+  using BaseEffect::begin;
+
+  // heat of each led, at least the cells where sparks ignite
+  size_t scratchSize() const override {
+    return max((int)_size, 7);
   }
 
-  void loop() override {
-    random16_add_entropy(random16());
+  void activate(uint8_t* scratch) override {
+    _heat = scratch;
+  }
 
-    // Step 1.  Cool down every cell a little
-    for (int i = 0; i < _controller->size(); i++) {
-      _heat[i] = qsub8(_heat[i],  random8(0, ((cooling * 10) / _controller->size()) + 2));
-    }
+  void loop(const FrameContext& frame) override {
+    if (!_heat)
+      return;
 
-  // Step 2.  Heat from each cell drifts 'up' and diffuses a little
-    for (int k= _controller->size() - 1; k >= 2; k--) {
-      _heat[k] = (_heat[k - 1] + _heat[k - 2] + _heat[k - 2]) / 3;
-    }
+    // a step of the simulation per frame at LEDEFFECT_RATE_FPS
+    uint32_t steps = frame.steps(1, _remainder);
+    if (steps > LEDEFFECT_FIRE_MAX_STEPS)
+      steps = LEDEFFECT_FIRE_MAX_STEPS;
 
-  // Step 3.  Randomly ignite new 'sparks' of heat near the bottom
-    if (random8() < sparking) {
-      int y = random8(7);
-      _heat[y] = qadd8(_heat[y], random8(160,255));
+    // loops have a fixed trip count when the strip has NUM_LEDS leds
+    if (_size == NUM_LEDS)
+      render<true>(steps);
+    else
+      render<false>(steps);
+  }
+
+protected:
+  template<bool FIXED_SIZE>
+  void render(uint32_t steps) {
+    const uint16_t size = FIXED_SIZE ? NUM_LEDS : _size;
+    const uint8_t coolingMax = ((cooling * 10) / size) + 2;
+    byte* heat = _heat;
+    CRGB* leds = _leds;
+
+    for (uint32_t step = 0; step < steps; step++) {
+      random16_add_entropy(random16());
+
+      // Step 1.  Cool down every cell a little
+      for (uint16_t i = 0; i < size; i++) {
+        heat[i] = qsub8(heat[i], random8(0, coolingMax));
+      }
+
+      // Step 2.  Heat from each cell drifts 'up' and diffuses a little
+      for (int k = size - 1; k >= 2; k--) {
+        heat[k] = (heat[k - 1] + heat[k - 2] + heat[k - 2]) / 3;
+      }
+
+      // Step 3.  Randomly ignite new 'sparks' of heat near the bottom
+      if (random8() < sparking) {
+        uint8_t y = random8(7);
+        heat[y] = qadd8(heat[y], random8(160, 255));
+      }
     }
 
-      // Step 4.  Map from heat cells to LED colors
-      for (int j = 0; j < _controller->size(); j++) {
-        // Scale the heat value from 0-255 down to 0-240
-        // for best results with color palettes.
-        byte colorindex = scale8(_heat[j], 240);
-        CRGB color = ColorFromPalette(HeatColors_p, colorindex);
-        int pixelnumber;
-        if (forward) {
-          pixelnumber = j;
-        } else {
-          pixelnumber = (_controller->size()-1) - j;
-        }
-        _controller->leds()[pixelnumber] = color;
+    // Step 4.  Map from heat cells to LED colors
+    if (forward) {
+      for (uint16_t j = 0; j < size; j++) {
+        leds[j] = heatColor(heat[j]);
+      }
+    } else {
+      for (uint16_t j = 0; j < size; j++) {
+        leds[size - 1 - j] = heatColor(heat[j]);
+      }
     }
   }
 
-protected:
-  byte _heat[NUM_LEDS];
+  static CRGB heatColor(uint8_t heat) {
+#ifdef LEDEFFECT_PALETTE_TABLE
+    return heatTable()[heat];
+#else
+    // Scale the heat value from 0-255 down to 0-240
+    // for best results with color palettes.
+    return ColorFromPalette(HeatColors_p, scale8(heat, 240));
+#endif
+  }
+
+  byte* _heat = 0;  // in the scratch memory
+  uint8_t _remainder = 0;
+
+#ifdef LEDEFFECT_PALETTE_TABLE
+  // heat colors indexed by heat, shared by all instances
+  static const PaletteTable& heatTable() {
+    static PaletteTable table;
+    static bool built = false;
+    if (!built) {
+      table.build(HeatColors_p, LINEARBLEND, 240);
+      built = true;
+    }
+    return table;
+  }
+#endif
 };
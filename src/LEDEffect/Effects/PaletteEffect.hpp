@@ -2,6 +2,7 @@
 
 #include "BaseEffect.hpp"
 #include "../PaletteData.hpp"
+#include "../PaletteTable.hpp"
 
 #define LEDEFFECT_DEFAULT_PALETTE PaletteData { RainbowColors_p, "rainbow" }
 
@@ -13,37 +14,51 @@ public:
 
   PaletteEffect(const char* name, const char* paletteName, TBlendType blend = NOBLEND,
     const PaletteData* palettes = 0, const size_t paletteCount = 0, const size_t jsonBufferSize = 0) :
-    BaseEffect(name, 2 * JSON_NODE_SIZE + jsonBufferSize),
+    BaseEffect(name, jsonBufferSize),
     blend(blend), _palettes(palettes), _paletteCount(paletteCount) {
       strcpy(this->paletteName, paletteName);
+      updatePalette();
     };
 
-  void deserialize(JsonObject& data) override {
-    // blend
-    if (data.containsKey("blend")) {
-      LEDEFFECT_DEBUG_PRINT(F("PaletteEffect: blend to "));
-      LEDEFFECT_DEBUG_PRINTLN(data["blend"].as<bool>());
-      blend = (TBlendType)data["blend"].as<bool>();
-    }
-
-    // palette
-    if (data.containsKey("palette")) {
-      LEDEFFECT_DEBUG_PRINT(F("PaletteEffect: palette to "));
-      LEDEFFECT_DEBUG_PRINTLN(data["palette"].as<const char*>());
-      strcpy(paletteName, data["palette"].as<const char*>());
-    }
+  const ParameterTable& parameters() const override {
+    static const Parameter parameters[] = {
+      Parameter("blend", &PaletteEffect::blend),
+      Parameter("palette", &PaletteEffect::paletteName)
+    };
+    static const ParameterTable table(parameters, 2);
+    return table;
   }
 
-  void serialize(JsonObject& data) const override {
-    data["blend"] = (bool)blend;
-    data["palette"] = paletteName;
+  void loop() override {
+#ifdef LEDEFFECT_PALETTE_TABLE
+    _paletteTable.fill(_leds, _size, 0, 255 / _size + 1);
+#else
+    fill_palette(_leds, _size, 0, 255 / _size + 1, _palette, 255, blend);
+#endif
   }
 
-  void loop() override {
-    fill_palette(_controller->leds(), _controller->size(), 0, 255 / _controller->size() + 1, PaletteFromName(paletteName), 255, blend);
+  bool isStatic() const override {
+    return true;
+  }
+
+  // resolve the palette from paletteName and blend, must be called after changing them
+  void updatePalette() {
+    _palette = PaletteFromName(paletteName, _palettes, _paletteCount);
+#ifdef LEDEFFECT_PALETTE_TABLE
+    _paletteTable.build(_palette, blend);
+#endif
   }
 
 protected:
+  void changed(const Parameter& parameter) override {
+    if (parameter.type == PARAMETER_BLEND || parameter.type == PARAMETER_PALETTE)
+      updatePalette();
+  }
+
+  CRGBPalette16 _palette;
+#ifdef LEDEFFECT_PALETTE_TABLE
+  PaletteTable _paletteTable;
+#endif
   const PaletteData* _palettes;
   const size_t _paletteCount;
 };
@@ -7,36 +7,35 @@ class RainbowEffect final : public BaseEffect
 {
 public:
   uint8_t deltaHue = 2;  // hue difference between two leds
-  int8_t rate = 1;       // rate of change of hue on each loop
-
-  RainbowEffect(const char* name) : BaseEffect(name, 2 * JSON_NODE_SIZE) { };
-
-  void deserialize(JsonObject& data) override {
-    // deltaHue
-    if (data.containsKey("delta_hue")) {
-      LEDEFFECT_DEBUG_PRINT(F("RainbowEffect: deltaHue to "));
-      LEDEFFECT_DEBUG_PRINTLN(data["delta_hue"].as<uint8_t>());
-      deltaHue = data["delta_hue"].as<uint8_t>();
-    }
-
-    // rate
-    if (data.containsKey("rate")) {
-      LEDEFFECT_DEBUG_PRINT(F("RainbowEffect: rate to "));
-      LEDEFFECT_DEBUG_PRINTLN(data["rate"].as<int8_t>());
-      rate = data["rate"].as<int8_t>();
-    }
+  int8_t rate = 1;       // rate of change of hue per frame at LEDEFFECT_RATE_FPS
+
+  RainbowEffect(const char* name) : BaseEffect(name) { };
+
+  const ParameterTable& parameters() const override {
+    static const Parameter parameters[] = {
+      Parameter("delta_hue", &RainbowEffect::deltaHue),
+      Parameter("rate", &RainbowEffect::rate)
+    };
+    static const ParameterTable table(parameters, 2);
+    return table;
+  }
+
+  void loop(const FrameContext& frame) override {
+    uint8_t steps = frame.steps(abs(rate), _remainder);
+    _hue += rate < 0 ? -steps : steps;
+    fill_rainbow(_leds, _size, _hue, deltaHue);
   }
 
-  void serialize(JsonObject& data) const override {
-    data["delta_hue"] = deltaHue;
-    data["rate"] = rate;
+  bool isStatic() const override {
+    return rate == 0;
   }
 
-  void loop() override {
-    _hue += rate;
-    fill_rainbow(_controller->leds(), _controller->size(), _hue, deltaHue);
+  // a step of hue changes a channel by up to 6
+  uint8_t activity() const override {
+    return min(abs(rate) * 6, 255);
   }
 
 protected:
   uint8_t _hue = 0;
+  uint8_t _remainder = 0;
 };
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "PaletteEffect.hpp"
+#include "../BitArray.hpp"
+#include "../ColorKernels.hpp"
 
 // light a random pixel which will get brighter (direction 1) then darker (direction 0) until black, bouncing if there is a minimal brightness
 template<size_t NUM_LEDS>
@@ -17,79 +19,102 @@ public:
     fract8 brightenRate = 32, fract8 fadeRate = 16, fract8 density = 150,
     const char* paletteName = "rainbow", TBlendType blend = NOBLEND,
     const PaletteData* palettes = 0, const size_t paletteCount = 0) :
-    PaletteEffect(name, paletteName, blend, palettes, paletteCount, 5 * JSON_NODE_SIZE),
+    PaletteEffect(name, paletteName, blend, palettes, paletteCount),
     initialBrightness(initialBrightness), maxBrightness(maxBrightness), brightenRate(brightenRate),
     fadeRate(fadeRate), density(density) { };
 
-  void deserialize(JsonObject& data) override {
-    PaletteEffect::deserialize(data);
+  const ParameterTable& parameters() const override {
+    static const Parameter parameters[] = {
+      Parameter("initial_brightness", &TwinkleEffect::initialBrightness),
+      Parameter("max_brightness", &TwinkleEffect::maxBrightness),
+      Parameter("brighten_rate", &TwinkleEffect::brightenRate),
+      Parameter("fade_rate", &TwinkleEffect::fadeRate),
+      Parameter("density", &TwinkleEffect::density)
+    };
+    static const ParameterTable table(parameters, 5, &PaletteEffect::parameters());
+    return table;
+  }
 
-    // initialBrightness
-    if (data.containsKey("initial_brightness")) {
-      LEDEFFECT_DEBUG_PRINT(F("TwinkleEffect: initialBrightness to "));
-      LEDEFFECT_DEBUG_PRINTLN(data["initial_brightness"].as<uint8_t>());
-      initialBrightness = data["initial_brightness"].as<uint8_t>();
+  void begin(CRGB* leds, uint16_t size) override {
+    if (size > NUM_LEDS) {
+      LEDEFFECT_DEBUG_PRINTLN(F("TwinkleEffect: More leds than NUM_LEDS, rendering NUM_LEDS"));
+      size = NUM_LEDS;
     }
+    BaseEffect::begin(leds, size);
+  }
 
-    // maxBrightness
-    if (data.containsKey("max_brightness")) {
-      LEDEFFECT_DEBUG_PRINT(F("TwinkleEffect: maxBrightness to "));
-      LEDEFFECT_DEBUG_PRINTLN(data["max_brightness"].as<uint8_t>());
-      maxBrightness = data["max_brightness"].as<uint8_t>();
-    }
+  using BaseEffect::begin;
 
-    // brightenRate
-    if (data.containsKey("brighten_rate")) {
-      LEDEFFECT_DEBUG_PRINT(F("TwinkleEffect: brightenRate to "));
-      LEDEFFECT_DEBUG_PRINTLN(data["brighten_rate"].as<fract8>());
-      brightenRate = data["brighten_rate"].as<fract8>();
-    }
+  size_t scratchSize() const override {
+    return BitArray::wordCount(_size) * sizeof(uint32_t);
+  }
 
-    // fadeRate
-    if (data.containsKey("fade_rate")) {
-      LEDEFFECT_DEBUG_PRINT(F("TwinkleEffect: fadeRate to "));
-      LEDEFFECT_DEBUG_PRINTLN(data["fade_rate"].as<fract8>());
-      fadeRate = data["fade_rate"].as<fract8>();
-    }
+  void activate(uint8_t* scratch) override {
+    _directions = BitArray((uint32_t*)scratch, scratch ? _size : 0);
+  }
 
-    // density
-    if (data.containsKey("density")) {
-      LEDEFFECT_DEBUG_PRINT(F("TwinkleEffect: density to "));
-      LEDEFFECT_DEBUG_PRINTLN(data["density"].as<fract8>());
-      density = data["density"].as<fract8>();
-    }
+  void loop(const FrameContext& frame) override {
+    if (!_directions.size())
+      return;
+
+    // loops have a fixed trip count when the strip has NUM_LEDS leds
+    if (_size == NUM_LEDS)
+      render<true>(frame);
+    else
+      render<false>(frame);
   }
 
-  void serialize(JsonObject& data) const override {
-    PaletteEffect::serialize(data);
-    data["initial_brightness"] = initialBrightness;
-    data["max_brightness"] = maxBrightness;
-    data["brighten_rate"] = brightenRate;
-    data["fade_rate"] = fadeRate;
-    data["density"] = density;
+  bool isStatic() const override {
+    return false;
   }
 
-  void loop() override {
-    for (int i = 0; i < _controller->size(); i++) {
-      if (_directions[i] == 1) {
-        CRGB color = _controller->leds()[i];
-        _controller->leds()[i] += color.nscale8(brightenRate);
-        if (_controller->leds()[i].r >= maxBrightness || _controller->leds()[i].g >= maxBrightness || _controller->leds()[i].b >= maxBrightness) {
-          _directions[i] = 0;
+  // new pixels appear at once whatever the frame rate, only fading and brightening are smoother with more frames
+  uint8_t activity() const override {
+    return max(fadeRate, scale8(maxBrightness, brightenRate));
+  }
+
+protected:
+  template<bool FIXED_SIZE>
+  void render(const FrameContext& frame) {
+    const uint16_t size = FIXED_SIZE ? NUM_LEDS : _size;
+    const uint8_t fadeScale = frame.scale(255 - fadeRate);
+    const uint8_t brightenScale = frame.grow(brightenRate);
+    CRGB* leds = _leds;
+
+    for (uint16_t start = 0; start < size;) {
+      uint16_t end = min((uint16_t)(start + BitArray::WORD_BITS), size);
+      uint32_t brightening = _directions.word(start / BitArray::WORD_BITS);
+
+      // only fading leds in this word and the following ones are faded at once
+      if (!brightening) {
+        while (end < size && !_directions.word(end / BitArray::WORD_BITS))
+          end = min((uint16_t)(end + BitArray::WORD_BITS), size);
+        ColorKernels::scale(leds + start, end - start, fadeScale);
+        start = end;
+        continue;
+      }
+
+      for (uint16_t i = start; i < end; i++, brightening >>= 1) {
+        if (brightening & 1) {
+          CRGB color = leds[i];
+          leds[i] += color.nscale8(brightenScale);
+          if (leds[i].r >= maxBrightness || leds[i].g >= maxBrightness || leds[i].b >= maxBrightness) {
+            _directions.clear(i);
+          }
+        } else {
+          leds[i].nscale8(fadeScale);
         }
-      } else {
-        _controller->leds()[i].nscale8(255 - fadeRate);
       }
+      start = end;
     }
-    if (random8() < density ) {
-      uint16_t pos = random16(_controller->size());
-      if (!_controller->leds()[pos]) {
-        _controller->leds()[pos] = ColorFromPalette(PaletteFromName(paletteName), random8(), initialBrightness, NOBLEND);
-        _directions[pos] = 1;
+    if (random8() < frame.chance(density)) {
+      uint16_t pos = random16(size);
+      if (!leds[pos]) {
+        leds[pos] = ColorFromPalette(_palette, random8(), initialBrightness, NOBLEND);
+        _directions.set(pos);
       }
     }
   }
 
-protected:
-  uint8_t _directions[NUM_LEDS];  // TODO: optimize with NUM_LEDS bits instead of bytes
+  BitArray _directions = BitArray(0, 0);  // set while brightening, cleared while fading, in the scratch memory
 };
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+#include "Configuration.hpp"
+
+// Frame rate at which the rates of the effects are given, e.g. a fade rate is the fade of one frame at 30 fps
+#ifndef LEDEFFECT_RATE_FPS
+#define LEDEFFECT_RATE_FPS 30
+#endif
+
+// Timing of a frame, given to BaseEffect::loop(const FrameContext&)
+//
+// Effects scale their rates to the time elapsed since their previous frame with steps(), scale(), fade(), grow() and
+// chance() so that they animate at the same speed whatever the frame rate and however late frames are. At
+// LEDEFFECT_RATE_FPS they return the rates themselves.
+struct FrameContext
+{
+  static const uint32_t RATE_PERIOD = 1000000UL / LEDEFFECT_RATE_FPS;  // us
+  static const uint32_t MAX_ELAPSED = 1000000UL;  // us, longer pauses animate as one second
+
+  uint32_t now;      // us
+  uint32_t elapsed;  // us since the previous frame
+  uint32_t period;   // us between frames at the target frame rate, 0 if unlimited
+  uint16_t ticks;    // elapsed in 1/256 of RATE_PERIOD
+
+  FrameContext(uint32_t now, uint32_t elapsed, uint32_t period) :
+    now(now), elapsed(elapsed < MAX_ELAPSED ? elapsed : MAX_ELAPSED), period(period),
+    ticks((this->elapsed * 256 + RATE_PERIOD / 2) / RATE_PERIOD) { };
+
+  // steps of rate per RATE_PERIOD over the elapsed time, the fraction of a step carried to the next frame in remainder
+  uint32_t steps(uint16_t rate, uint8_t& remainder) const {
+    uint32_t total = (uint32_t)rate * ticks + remainder;
+    remainder = total & 0xFF;
+    return total >> 8;
+  }
+
+  // scale of an nscale8 by scale per RATE_PERIOD compounded over the elapsed time
+  uint8_t scale(uint8_t scale) const {
+    uint8_t result = 255;
+    for (uint16_t i = 0; i < ticks >> 8 && result; i++)
+      result = scale8(result, scale);
+    return result - scale8(result - scale8(result, scale), ticks & 0xFF);
+  }
+
+  // amount of a fadeToBlackBy by fade per RATE_PERIOD compounded over the elapsed time
+  uint8_t fade(uint8_t fade) const {
+    return 255 - scale(255 - fade);
+  }
+
+  // amount of a nscale8 added to itself, growing by rate / 256 per RATE_PERIOD compounded over the elapsed time
+  uint8_t grow(uint8_t rate) const {
+    uint32_t result = 256;  // 8.8 factor
+    for (uint16_t i = 0; i < ticks >> 8 && result < 512; i++)
+      result = result * (256 + rate) >> 8;
+    result += ((result * (256 + rate) >> 8) - result) * (ticks & 0xFF) >> 8;
+    return min(result - 256, (uint32_t)255);
+  }
+
+  // chance out of 256 of an event with chance out of 256 per RATE_PERIOD over the elapsed time, at most 255
+  uint8_t chance(uint8_t chance) const {
+    return min((uint32_t)chance * ticks >> 8, (uint32_t)255);
+  }
+};
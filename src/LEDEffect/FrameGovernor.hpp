@@ -0,0 +1,75 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "FrameContext.hpp"
+
+// Change of a channel per frame that still looks smooth, the adaptive frame rate is the one at which the activity
+// of the effect changes the leds by this much per frame
+#ifndef LEDEFFECT_SMOOTH_STEP
+#define LEDEFFECT_SMOOTH_STEP 4
+#endif
+
+// Share of the frame period that render and show may take with an adaptive frame rate, in 1/256
+#ifndef LEDEFFECT_FRAME_LOAD
+#define LEDEFFECT_FRAME_LOAD 205
+#endif
+
+// Adapts the frame rate to the activity of the effect and to the time a frame takes
+//
+// The rate is the one at which the activity changes a channel by LEDEFFECT_SMOOTH_STEP per frame, lowered so that
+// the mean render and show time fits in LEDEFFECT_FRAME_LOAD of the period, within the min and max fps. It drops at
+// once and rises by an eighth per frame so that a single fast frame does not make it jump.
+class FrameGovernor
+{
+public:
+  // add the render and show time of a frame, in microseconds
+  void measure(uint32_t micros) {
+    // mean over about 8 frames
+    if (!_cost)
+      _cost = micros;
+    else if (micros > _cost)
+      _cost += (micros - _cost) / 8;
+    else
+      _cost -= (_cost - micros) / 8;
+  }
+
+  // update the frame rate for the activity of the effect between minFps and maxFps and return it
+  uint8_t update(uint8_t activity, uint8_t minFps, uint8_t maxFps) {
+    uint32_t target = (uint32_t)LEDEFFECT_RATE_FPS * activity / LEDEFFECT_SMOOTH_STEP;
+    if (_cost) {
+      uint32_t affordable = 1000000UL / 256 * LEDEFFECT_FRAME_LOAD / _cost;
+      if (target > affordable)
+        target = affordable;
+    }
+    if (target > maxFps)
+      target = maxFps;
+    if (target < minFps)
+      target = minFps;
+
+    if (_fps == 0 || target < _fps)
+      _fps = target;
+    else if (target > _fps)
+      _fps += min(target - _fps, (uint32_t)(_fps / 8 + 1));
+    return _fps;
+  }
+
+  // frame rate of the last update, 0 before the first one
+  uint8_t fps() const {
+    return _fps;
+  }
+
+  // mean render and show time, in microseconds
+  uint32_t cost() const {
+    return _cost;
+  }
+
+  void reset() {
+    _fps = 0;
+    _cost = 0;
+  }
+
+private:
+  uint8_t _fps = 0;
+  uint32_t _cost = 0;
+};
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+#include "Configuration.hpp"
+#include "OutputSink.hpp"
+
+// Recording of frames, written by FrameRecorder and read by FrameReader
+//
+// A recording is a header followed by the frames, each encoded against the previous one, black before the first:
+//   header  "LEFR", version 1, led count (2 bytes, little-endian), frames per second (0 if unknown)
+//   frame   brightness, then runs until every led is covered:
+//     0nnnnnnn  n + 1 leds unchanged
+//     10nnnnnn  n + 1 leds, 3 bytes each
+//     11nnnnnn  n + 1 leds of the 3 bytes color that follows
+// A frame that did not change is 2 bytes per 128 leds, a solid color 4 bytes per 64 leds.
+#define LEDEFFECT_RECORDING_VERSION 1
+#define LEDEFFECT_RECORDING_HEADER_SIZE 8
+
+// Output to a recording printed to print, e.g. a file
+class FrameRecorder : public OutputSink
+{
+public:
+  FrameRecorder(Print& print, uint8_t fps = 0) : _print(print), _fps(fps) { };
+
+  ~FrameRecorder() {
+    free(_previous);
+  }
+
+  void show(const CRGB* leds, uint16_t size, uint8_t brightness) override {
+    if (!_previous) {
+      _previous = (CRGB*)calloc(size, sizeof(CRGB));
+      if (!_previous) {
+        LEDEFFECT_DEBUG_PRINTLN(F("FrameRecorder: Out of memory"));
+        return;
+      }
+      _size = size;
+      uint8_t header[LEDEFFECT_RECORDING_HEADER_SIZE] = { 'L', 'E', 'F', 'R', LEDEFFECT_RECORDING_VERSION,
+        (uint8_t)size, (uint8_t)(size >> 8), _fps };
+      write(header, sizeof(header));
+    }
+    if (size != _size) {
+      LEDEFFECT_DEBUG_PRINTLN(F("FrameRecorder: Led count changed, frame dropped"));
+      return;
+    }
+
+    write(&brightness, 1);
+    for (uint16_t i = 0; i < size;) {
+      uint16_t count = 1;
+      if (leds[i] == _previous[i]) {
+        while (i + count < size && count < 128 && leds[i + count] == _previous[i + count])
+          count++;
+        writeRun(count - 1, 0, 0);
+      } else if (i + 1 < size && leds[i + 1] == leds[i]) {
+        while (i + count < size && count < 64 && leds[i + count] == leds[i])
+          count++;
+        writeRun(0xC0 | (count - 1), &leds[i], 1);
+      } else {
+        // until an unchanged led or a run of a color, which are shorter on their own
+        while (i + count < size && count < 64 && leds[i + count] != _previous[i + count] &&
+            (i + count + 1 >= size || leds[i + count + 1] != leds[i + count]))
+          count++;
+        writeRun(0x80 | (count - 1), &leds[i], count);
+      }
+      i += count;
+    }
+
+    memcpy(_previous, leds, size * sizeof(CRGB));
+    _frames++;
+  }
+
+  // frames recorded
+  uint32_t frames() const {
+    return _frames;
+  }
+
+  // bytes written, header included
+  uint32_t bytes() const {
+    return _bytes;
+  }
+
+protected:
+  Print& _print;
+  uint8_t _fps;
+  CRGB* _previous = 0;
+  uint16_t _size = 0;
+  uint32_t _frames = 0;
+  uint32_t _bytes = 0;
+
+  void write(const uint8_t* data, size_t size) {
+    _bytes += _print.write(data, size);
+  }
+
+  void writeRun(uint8_t run, const CRGB* leds, uint16_t count) {
+    write(&run, 1);
+    if (count)
+      write((const uint8_t*)leds, count * sizeof(CRGB));
+  }
+};
+
+// Frames of a recording in memory, e.g. a memory-mapped file or flash, decoded one after the other
+class FrameReader
+{
+public:
+  FrameReader(const uint8_t* data, size_t size) : _data(data), _dataSize(size) {
+    _valid = size >= LEDEFFECT_RECORDING_HEADER_SIZE && memcmp(data, "LEFR", 4) == 0 &&
+      data[4] == LEDEFFECT_RECORDING_VERSION;
+    if (!_valid) {
+      LEDEFFECT_DEBUG_PRINTLN(F("FrameReader: Not a recording"));
+      return;
+    }
+    _size = data[5] | data[6] << 8;
+    _fps = data[7];
+    rewind();
+  }
+
+  // whether the data is a recording this reader can decode
+  bool valid() const {
+    return _valid;
+  }
+
+  // leds of every frame
+  uint16_t size() const {
+    return _size;
+  }
+
+  // frames per second of the recording, 0 if unknown
+  uint8_t fps() const {
+    return _fps;
+  }
+
+  // frames decoded since the start
+  uint32_t frames() const {
+    return _frames;
+  }
+
+  // decode the next frame into size() leds holding the frame decoded last, return false at the end or if the
+  // recording is truncated or corrupted
+  bool next(CRGB* leds, uint8_t* brightness = 0) {
+    if (!_valid || _position >= _dataSize)
+      return false;
+    if (_frames == 0)
+      fill_solid(leds, _size, CRGB::Black);
+
+    uint8_t frameBrightness = _data[_position++];
+    for (uint16_t i = 0; i < _size;) {
+      if (_position >= _dataSize)
+        return corrupted();
+      uint8_t run = _data[_position++];
+      uint16_t count = (run < 0x80 ? run : run & 0x3F) + 1;
+      if (count > _size - i)
+        return corrupted();
+
+      if (run >= 0x80) {
+        size_t bytes = (run < 0xC0 ? count : 1) * sizeof(CRGB);
+        if (bytes > _dataSize - _position)
+          return corrupted();
+        if (run < 0xC0)
+          memcpy(&leds[i], &_data[_position], bytes);
+        else
+          fill_solid(&leds[i], count, CRGB(_data[_position], _data[_position + 1], _data[_position + 2]));
+        _position += bytes;
+      }
+      i += count;
+    }
+
+    if (brightness)
+      *brightness = frameBrightness;
+    _frames++;
+    return true;
+  }
+
+  // restart from the first frame
+  void rewind() {
+    _position = LEDEFFECT_RECORDING_HEADER_SIZE;
+    _frames = 0;
+  }
+
+protected:
+  const uint8_t* _data;
+  size_t _dataSize;
+  size_t _position = 0;
+  bool _valid = false;
+  uint16_t _size = 0;
+  uint8_t _fps = 0;
+  uint32_t _frames = 0;
+
+  bool corrupted() {
+    LEDEFFECT_DEBUG_PRINTLN(F("FrameReader: Recording truncated or corrupted"));
+    _position = _dataSize;
+    return false;
+  }
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Schedules frames against absolute deadlines so that render and show time are part of the frame period
+class FrameScheduler
+{
+public:
+  uint32_t frames = 0;         // frames started
+  uint32_t lateFrames = 0;     // frames finished after the deadline of the next frame
+  uint32_t droppedFrames = 0;  // deadlines skipped because a frame was not even started in time
+
+  // whether a frame is due at now (in microseconds), a period of fps after the last frame when the rate changed
+  bool due(uint32_t now, uint8_t fps) const {
+    if (fps == 0 || _fps == 0)
+      return true;
+    uint32_t deadline = fps == _fps ? _deadline : _start + 1000000UL / fps;
+    return (int32_t)(now - deadline) >= 0;
+  }
+
+  // start a frame at now, due() must be true
+  void start(uint32_t now, uint8_t fps) {
+    frames++;
+    if (fps == 0) {
+      _fps = 0;
+      return;
+    }
+
+    uint32_t period = 1000000UL / fps;
+    if (_fps == 0) {
+      // start the schedule from now
+      _deadline = now;
+    } else {
+      // a new rate keeps the phase of the last frame
+      if (fps != _fps)
+        _deadline = _start + period;
+      // skip the deadlines we missed entirely, keeping the schedule phase
+      uint32_t missed = (now - _deadline) / period;
+      droppedFrames += missed;
+      _deadline += missed * period;
+    }
+    _fps = fps;
+    _start = now;
+    _deadline += period;
+  }
+
+  // finish the frame started last at now
+  void finish(uint32_t now) {
+    if (_fps > 0 && (int32_t)(now - _deadline) > 0)
+      lateFrames++;
+  }
+
+  // time left until the next frame is due, 0 if it is already due
+  uint32_t remaining(uint32_t now) const {
+    if (_fps == 0 || (int32_t)(now - _deadline) >= 0)
+      return 0;
+    return _deadline - now;
+  }
+
+private:
+  uint8_t _fps = 0;
+  uint32_t _start = 0;     // of the last frame
+  uint32_t _deadline = 0;  // of the next frame
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <ArduinoJson.h>
+
+// JSON buffer allocated once and cleared before each use, so that parsing and serializing do not touch the heap
+class JsonArena : public ArduinoJson::Internals::StaticJsonBufferBase
+{
+public:
+  explicit JsonArena(size_t capacity) : JsonArena(new char[capacity], capacity) { };
+
+  ~JsonArena() {
+    delete[] _memory;
+  }
+
+  JsonArena(const JsonArena&) = delete;
+  JsonArena& operator=(const JsonArena&) = delete;
+
+  using StaticJsonBufferBase::clear;
+
+private:
+  char* _memory;
+
+  JsonArena(char* memory, size_t capacity) : StaticJsonBufferBase(memory, capacity), _memory(memory) { };
+};
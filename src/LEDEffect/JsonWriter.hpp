@@ -0,0 +1,156 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Streams JSON to a Print as it is written, formatted exactly like ArduinoJson's printTo
+class JsonWriter
+{
+public:
+  JsonWriter(Print& print) : _print(print) { };
+
+  void beginObject() {
+    separate();
+    write('{');
+    _comma = false;
+  }
+
+  void endObject() {
+    write('}');
+    _comma = true;
+  }
+
+  void beginArray() {
+    separate();
+    write('[');
+    _comma = false;
+  }
+
+  void endArray() {
+    write(']');
+    _comma = true;
+  }
+
+  void key(const char* key) {
+    separate();
+    string(key);
+    write(':');
+    _comma = false;
+  }
+
+  void value(const char* value) {
+    separate();
+    if (value)
+      string(value);
+    else
+      _size += _print.print("null");
+    _comma = true;
+  }
+
+  void value(bool value) {
+    separate();
+    _size += _print.print(value ? "true" : "false");
+    _comma = true;
+  }
+
+  void value(int value) { number((long)value); }
+  void value(unsigned int value) { number((unsigned long)value); }
+  void value(long value) { number(value); }
+  void value(unsigned long value) { number(value); }
+
+  // any value with a printTo(Print&) method, e.g. a JsonVariant
+  template<typename T>
+  void printable(const T& value) {
+    separate();
+    _size += value.printTo(_print);
+    _comma = true;
+  }
+
+  template<typename T>
+  void member(const char* name, const T& value) {
+    key(name);
+    this->value(value);
+  }
+
+  size_t size() const {
+    return _size;
+  }
+
+private:
+  Print& _print;
+  size_t _size = 0;
+  bool _comma = false;
+
+  void separate() {
+    if (_comma)
+      write(',');
+  }
+
+  void write(char c) {
+    _size += _print.write(c);
+  }
+
+  template<typename T>
+  void number(T value) {
+    separate();
+    _size += _print.print(value);
+    _comma = true;
+  }
+
+  void string(const char* value) {
+    write('"');
+    for (const char* c = value; *c; c++) {
+      switch (*c) {
+        case '"': write('\\'); write('"'); break;
+        case '\\': write('\\'); write('\\'); break;
+        case '\b': write('\\'); write('b'); break;
+        case '\f': write('\\'); write('f'); break;
+        case '\n': write('\\'); write('n'); break;
+        case '\r': write('\\'); write('r'); break;
+        case '\t': write('\\'); write('t'); break;
+        default: write(*c);
+      }
+    }
+    write('"');
+  }
+};
+
+// Print to a fixed size char buffer, always null terminated and truncated if needed
+class BufferPrint : public Print
+{
+public:
+  BufferPrint(char* buffer, size_t bufferSize) : _buffer(buffer), _bufferSize(bufferSize) {
+    if (_bufferSize > 0)
+      _buffer[0] = 0;
+  };
+
+  size_t write(uint8_t c) override {
+    if (_length + 1 >= _bufferSize)
+      return 0;
+    _buffer[_length++] = c;
+    _buffer[_length] = 0;
+    return 1;
+  }
+
+  using Print::write;
+
+private:
+  char* _buffer;
+  size_t _bufferSize;
+  size_t _length = 0;
+};
+
+// Print appending to a String
+class StringPrint : public Print
+{
+public:
+  StringPrint(String& str) : _str(str) { };
+
+  size_t write(uint8_t c) override {
+    return _str.concat((char)c) ? 1 : 0;
+  }
+
+  using Print::write;
+
+private:
+  String& _str;
+};
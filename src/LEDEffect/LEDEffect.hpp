@@ -4,42 +4,101 @@
 #include <FastLED.h>
 
 #include "Effects/BaseEffect.hpp"
+#include "ColorKernels.hpp"
+#include "CommandStage.hpp"
 #include "Configuration.hpp"
+#include "DdpReceiver.hpp"
+#include "DdpSink.hpp"
+#include "EffectRegistry.hpp"
+#include "FrameContext.hpp"
+#include "FrameGovernor.hpp"
+#include "FrameRecorder.hpp"
+#include "FrameScheduler.hpp"
+#include "JsonArena.hpp"
+#include "OutputSink.hpp"
+#include "OutputStage.hpp"
+#include "Stats.hpp"
+#include "Transition.hpp"
 
 class LedEffect
 {
 public:
+  typedef void (*StateCallback)(LedEffect& strip);
+
   bool state = true;
   uint8_t brightness = 50;
-  uint8_t brightnessRate = 8;
+  uint8_t brightnessRate = 8;  // per frame at LEDEFFECT_RATE_FPS
   uint8_t fps = 30;
+  uint8_t minFps = 0;  // adapt the frame rate between minFps and fps to the effect and the frame time, 0 for fixed
+  uint16_t transition = 0;  // crossfade between effects in ms, 0 to switch at once
+  bool blocking = true;  // wait for the frame period in loop(), set to false to return at once when no frame is due
+  bool skipStaticFrames = true;  // skip render and show when the frame would not change
+  // apply gamma, brightness and white balance in one pass through lookup tables instead of the controller or sink
+  // brightness, into the front or segment buffer or a buffer of its own, call invalidate() after changing them
+  bool outputStage = false;
+  float gamma = 2.2f;
+  CRGB whiteBalance = CRGB(255, 255, 255);
+  uint16_t ingestTimeout = 2500;  // ms without a frame from the receiver before the effect renders again
+  StateCallback stateCallback = 0;  // called by loop() at most once per frame after commands changed the state
 
   LedEffect(BaseEffect** effects, uint8_t effectCount) : _effects(effects), _effectCount(effectCount) { };
 
+  // effects constructed on selection, only the selected one is in memory
+  LedEffect(EffectRegistry& registry) : _registry(&registry) { };
+
+  ~LedEffect() {
+    free(_scratch);
+    free(_transitionScratch);
+    delete[] _stats.effects;
+    delete[] _stats.outputs;
+    delete _stage;
+#ifdef LEDEFFECT_JSON_ARENA
+    delete _jsonArena;
+#endif
+  }
+
+  // the strip owns its scratch memory, stats, output stage and JSON arena
+  LedEffect(const LedEffect&) = delete;
+  LedEffect& operator=(const LedEffect&) = delete;
+
   void begin(CLEDController* controller, CFastLED fastLed) {
     _fastLed = fastLed;
-    _controller = controller;
     _fastLed.setBrightness(brightness);
+    _controller = controller;
+    _output = 0;
+    _segment = false;
+    beginEffects(controller->leds(), controller->size());
+  }
 
-    size_t maxEffectJsonBufferSize = 0;
-    for (uint8_t i = 0; i < _effectCount; i++) {
-      _effects[i]->begin(_controller);
-      if (_effects[i]->jsonBufferSize > maxEffectJsonBufferSize)
-        maxEffectJsonBufferSize = _effects[i]->jsonBufferSize;
-    }
+  void begin(CLEDController* controller) {
+    begin(controller, FastLED);
+  }
 
-    LEDEFFECT_DEBUG_PRINT(F("LEDEffect: JSON buffer size is "));
-    LEDEFFECT_DEBUG_PRINT(_jsonBufferSize);
-    LEDEFFECT_DEBUG_PRINT(F(" (base) + "));
-    LEDEFFECT_DEBUG_PRINT(maxEffectJsonBufferSize);
-    LEDEFFECT_DEBUG_PRINT(F(" (effects) = "));
-    LEDEFFECT_DEBUG_PRINTLN(_jsonBufferSize + maxEffectJsonBufferSize);
+  // render into leds and output to sink, through front when given so that the sink outputs a frame while the
+  // next one renders in leds
+  void begin(OutputSink* sink, CRGB* leds, uint16_t size, CRGB* front = 0) {
+    _sink = sink;
+    _front = front;
+    _controller = 0;
+    _output = 0;
+    _segment = false;
+    beginEffects(leds, size);
+  }
 
-    _jsonBufferSize += maxEffectJsonBufferSize;
+  // begin as a segment of a LedEffectGroup rendering into the whole controller
+  void beginSegment(CLEDController* controller) {
+    _controller = controller;
+    _output = 0;
+    _segment = true;
+    beginEffects(controller->leds(), controller->size());
   }
 
-  void begin(CLEDController* controller) {
-    begin(controller, FastLED);
+  // begin as a segment of a LedEffectGroup rendering into buffer, copied to size leds of the controller from offset
+  void beginSegment(CLEDController* controller, uint16_t offset, uint16_t size, CRGB* buffer) {
+    _controller = controller;
+    _output = controller->leds() + offset;
+    _segment = true;
+    beginEffects(buffer, size);
   }
 
   bool deserialize(JsonObject& root) {
@@ -50,68 +109,257 @@ public:
       return false;
     }
 
-    // state
-    if (root.containsKey("state")) {
-      LEDEFFECT_DEBUG_PRINT(F("LED Effect: state to "));
-      LEDEFFECT_DEBUG_PRINTLN(root["state"].as<char*>());
-      if (strcmp(root["state"], "ON") == 0) {
-        state = true;
-      } else if (strcmp(root["state"], "OFF") == 0) {
-        state = false;
-      }
-    }
-
-    // brightness
-    if (root.containsKey("brightness")) {
-      LEDEFFECT_DEBUG_PRINT(F("LED Effect: brightness to "));
-      LEDEFFECT_DEBUG_PRINTLN(root["brightness"].as<uint8_t>());
-      brightness = root["brightness"].as<uint8_t>();
-    }
-
-    // brightness_rate
-    if (root.containsKey("brightness_rate")) {
-      LEDEFFECT_DEBUG_PRINT(F("LED Effect: brightnessRate to "));
-      LEDEFFECT_DEBUG_PRINTLN(root["brightness_rate"].as<uint8_t>());
-      brightnessRate = root["brightness_rate"].as<uint8_t>();
-    }
-
-    // fps
-    if (root.containsKey("fps")) {
-      LEDEFFECT_DEBUG_PRINT(F("LED Effect: fps to "));
-      LEDEFFECT_DEBUG_PRINTLN(root["fps"].as<int>());
-      fps = root["fps"].as<uint8_t>();
-    }
-
-    // effect
-    if (root.containsKey("effect")) {
-      JsonObject& effect = root["effect"];
-      if (effect.containsKey("name")) {
-        LEDEFFECT_DEBUG_PRINT(F("LED Effect: effect to "));
-        LEDEFFECT_DEBUG_PRINTLN(effect["name"].as<char*>());
-        for (uint8_t i = 0; i < _effectCount; i++) {
-          if (strcmp(effect["name"], _effects[i]->name) == 0) {
-            _currentEffect = i;
+    // single pass over the members
+    for (auto member : root) {
+      if (strcmp(member.key, "state") == 0) {
+        LEDEFFECT_DEBUG_PRINT(F("LED Effect: state to "));
+        LEDEFFECT_DEBUG_PRINTLN(member.value.as<const char*>());
+        const char* value = member.value.as<const char*>();
+        if (value && strcmp(value, "ON") == 0) {
+          state = true;
+        } else if (value && strcmp(value, "OFF") == 0) {
+          state = false;
+        }
+      } else if (strcmp(member.key, "brightness") == 0) {
+        LEDEFFECT_DEBUG_PRINT(F("LED Effect: brightness to "));
+        LEDEFFECT_DEBUG_PRINTLN(member.value.as<uint8_t>());
+        brightness = member.value.as<uint8_t>();
+      } else if (strcmp(member.key, "brightness_rate") == 0) {
+        LEDEFFECT_DEBUG_PRINT(F("LED Effect: brightnessRate to "));
+        LEDEFFECT_DEBUG_PRINTLN(member.value.as<uint8_t>());
+        brightnessRate = member.value.as<uint8_t>();
+      } else if (strcmp(member.key, "fps") == 0) {
+        LEDEFFECT_DEBUG_PRINT(F("LED Effect: fps to "));
+        LEDEFFECT_DEBUG_PRINTLN(member.value.as<int>());
+        fps = member.value.as<uint8_t>();
+      } else if (strcmp(member.key, "min_fps") == 0) {
+        LEDEFFECT_DEBUG_PRINT(F("LED Effect: minFps to "));
+        LEDEFFECT_DEBUG_PRINTLN(member.value.as<int>());
+        minFps = member.value.as<uint8_t>();
+      } else if (strcmp(member.key, "transition") == 0) {
+        LEDEFFECT_DEBUG_PRINT(F("LED Effect: transition to "));
+        LEDEFFECT_DEBUG_PRINTLN(member.value.as<int>());
+        transition = member.value.as<uint16_t>();
+      } else if (strcmp(member.key, "effect") == 0) {
+        JsonObject& effect = member.value.as<JsonObject&>();
+        const char* name = effect["name"];
+        if (name) {
+          LEDEFFECT_DEBUG_PRINT(F("LED Effect: effect to "));
+          LEDEFFECT_DEBUG_PRINTLN(name);
+          int16_t index = findEffect(name);
+          if (index >= 0) {
+            selectEffect(index);
             LEDEFFECT_DEBUG_PRINT(F("LED Effect: Switch to effect "));
             LEDEFFECT_DEBUG_PRINTLN(_currentEffect);
-            break;
           }
         }
+        if (_effect)
+          _effect->deserialize(effect);
       }
-      _effects[_currentEffect]->deserialize(effect);
     }
 
+    invalidate();
+    _stateChanged = true;
     return true;
   }
 
   bool deserialize(char* data) {
+    uint32_t start = micros();
+    _stats.deserializeBytes += strlen(data);
+
+#ifdef LEDEFFECT_JSON_ARENA
+    JsonArena& jsonBuffer = jsonArena();
+#else
     DynamicJsonBuffer jsonBuffer(_jsonBufferSize);
+#endif
     JsonObject& root = jsonBuffer.parseObject(data);
     LEDEFFECT_DEBUG_PRINT(F("LED Effect: JSON Buffer "));
     LEDEFFECT_DEBUG_PRINT(jsonBuffer.size());
     LEDEFFECT_DEBUG_PRINT(F("/"));
     LEDEFFECT_DEBUG_PRINTLN(_jsonBufferSize);
 
-    return deserialize(root);
+    bool success = deserialize(root);
+    _stats.deserialize.add(micros() - start);
+    return success;
+  }
+
+  // apply a binary command, the same as a JSON one in fewer bytes and without a JSON buffer
+  //
+  // A command is a sequence of fields, each a one byte id followed by its value, in any order:
+  //   1  state            1 byte, 0 for OFF
+  //   2  brightness       1 byte
+  //   3  brightness_rate  1 byte
+  //   4  fps              1 byte
+  //   5  effect           1 byte index of the effect, the remaining fields are parameters of that effect
+  //   6  transition       2 bytes, ms
+  //   7  min_fps          1 byte
+  // Effect parameters are numbered from 1 in the order of the JSON state, each effect defines their values,
+  // e.g. {"brightness": 128, "effect": {"name": "<effect 1>", "fade_rate": 24}} with twinkle as effect 1 is
+  // 02 80 05 01 06 18. Integers are little-endian, colors are 3 bytes and strings are a length byte followed
+  // by the characters. Fields before an unknown id or a truncated value are applied.
+  bool deserialize(const uint8_t* data, size_t size) {
+    LEDEFFECT_DEBUG_PRINTLN(F("LED Effect: Deserializing binary..."));
+    uint32_t start = micros();
+    _stats.deserializeBytes += size;
+
+    BinaryReader reader(data, size);
+    uint8_t id = 0;
+    while (reader.available() && reader.read(id)) {
+      uint8_t value;
+      switch (id) {
+        case 1:  // state
+          if (reader.read(value))
+            state = value != 0;
+          break;
+        case 2:  // brightness
+          reader.read(brightness);
+          break;
+        case 3:  // brightness_rate
+          reader.read(brightnessRate);
+          break;
+        case 4:  // fps
+          reader.read(fps);
+          break;
+        case 5:  // effect
+          if (!reader.read(value))
+            break;
+          if (value >= effectCount()) {
+            reader.fail();
+            break;
+          }
+          selectEffect(value);
+          while (reader.available() && reader.read(id)) {
+            if (!_effect || !_effect->deserialize(reader, id))
+              reader.fail();
+          }
+          break;
+        case 6:  // transition
+          reader.read(transition);
+          break;
+        case 7:  // min_fps
+          reader.read(minFps);
+          break;
+        default:
+          reader.fail();
+      }
+    }
+
+    invalidate();
+    _stateChanged = true;
+    _stats.deserialize.add(micros() - start);
+
+    if (reader.failed()) {
+      LEDEFFECT_DEBUG_PRINT(F("LED Effect: Invalid binary command at id "));
+      LEDEFFECT_DEBUG_PRINTLN(id);
+      return false;
+    }
+    return true;
+  }
+
+  // queue a command to apply at the next frame, merged field by field with the commands queued since the last
+  // frame, return false if it is invalid, the fields before the invalid one being queued
+  //
+  // A burst of commands, e.g. from a slider, is applied once with the last value of each field and stateCallback is
+  // called once. Queuing parses the command but leaves the effect untouched. A command switching to another effect
+  // is applied at once after the queued ones, as the fields of an effect are only known once it is selected.
+  bool queue(char* data) {
+    uint32_t start = micros();
+
+#ifdef LEDEFFECT_JSON_ARENA
+    JsonArena& jsonBuffer = jsonArena();
+#else
+    DynamicJsonBuffer jsonBuffer(_jsonBufferSize);
+#endif
+    JsonObject& root = jsonBuffer.parseObject(data);
+    bool success = queue(root);
+    _stats.queue.add(micros() - start);
+    return success;
+  }
+
+  bool queue(JsonObject& root) {
+    if (!root.success()) {
+      LEDEFFECT_DEBUG_PRINTLN(F("LED Effect: JSON Parse failed"));
+      return false;
+    }
+
+    JsonObject& effect = root["effect"];
+    const char* name = effect.success() ? effect["name"].as<const char*>() : 0;
+    int16_t index = name ? findEffect(name) : -1;
+    if (index >= 0 && (!_effect || index != _currentEffect)) {
+      applyQueued();
+      return deserialize(root);
+    }
+
+    for (auto member : root) {
+      uint8_t value[2];
+      if (strcmp(member.key, "state") == 0) {
+        const char* state = member.value.as<const char*>();
+        if (!state || (strcmp(state, "ON") != 0 && strcmp(state, "OFF") != 0))
+          continue;
+        value[0] = strcmp(state, "ON") == 0;
+        queueField(1, value, 1);
+      } else if (strcmp(member.key, "brightness") == 0) {
+        value[0] = member.value.as<uint8_t>();
+        queueField(2, value, 1);
+      } else if (strcmp(member.key, "brightness_rate") == 0) {
+        value[0] = member.value.as<uint8_t>();
+        queueField(3, value, 1);
+      } else if (strcmp(member.key, "fps") == 0) {
+        value[0] = member.value.as<uint8_t>();
+        queueField(4, value, 1);
+      } else if (strcmp(member.key, "transition") == 0) {
+        uint16_t transition = member.value.as<uint16_t>();
+        value[0] = transition;
+        value[1] = transition >> 8;
+        queueField(6, value, 2);
+      } else if (strcmp(member.key, "min_fps") == 0) {
+        value[0] = member.value.as<uint8_t>();
+        queueField(7, value, 1);
+      } else if (strcmp(member.key, "effect") == 0 && _effect) {
+        const ParameterTable& table = _effect->parameters();
+        for (auto field : effect) {
+          uint8_t id = table.number(field.key);
+          uint8_t data[LEDEFFECT_PALETTE_NAME_MAX_LENGTH];
+          uint8_t size = id ? table.at(id)->encode(field.value, data) : 0;
+          if (size)
+            queueEffectField(id, data, size);
+        }
+      }
+    }
+    return true;
+  }
+
+  // queue a binary command, see queue(char*) and deserialize(const uint8_t*, size_t)
+  bool queue(const uint8_t* data, size_t size) {
+    uint32_t start = micros();
+    bool success = queueBinary(data, size);
+    _stats.queue.add(micros() - start);
+    if (!success) {
+      LEDEFFECT_DEBUG_PRINTLN(F("LED Effect: Invalid binary command"));
+    }
+    return success;
+  }
+
+  // apply the queued commands now instead of at the next frame
+  void applyQueued() {
+    if (_commands.empty())
+      return;
+
+    // fields of an effect switched from by deserialize() since they were queued are dropped
+    _commands.setEffect(_currentEffect);
+    uint8_t command[LEDEFFECT_STAGE_SIZE + 1];
+    size_t size = _commands.command(command);
+    _commands.clear();
+    deserialize(command, size);
+  }
+
+  // call stateCallback if commands changed the state since it was last called
+  void notifyState() {
+    if (!_stateChanged)
+      return;
+    _stateChanged = false;
+    if (stateCallback)
+      stateCallback(*this);
   }
 
   void serialize(JsonObject& root) {
@@ -121,87 +369,689 @@ public:
     root["brightness"] = brightness;
     root["brightness_rate"] = brightnessRate;
     root["fps"] = fps;
+    root["min_fps"] = minFps;
+    root["achieved_fps"] = _stats.fps;
+    root["transition"] = transition;
     JsonObject& effect = root.createNestedObject("effect");
-    effect["name"] = _effects[_currentEffect]->name;
-    _effects[_currentEffect]->serialize(effect);
+    if (_effect) {
+      effect["name"] = _effect->name;
+      _effect->serialize(effect);
+    }
   }
 
-  size_t printTo(char* buffer, size_t bufferSize) {
-    DynamicJsonBuffer jsonBuffer(_jsonBufferSize);
-    JsonObject& root = jsonBuffer.createObject();
-    serialize(root);
+  // stream the same JSON as serialize(JsonObject&) without building it in a JSON buffer
+  void serialize(JsonWriter& writer) {
+    LEDEFFECT_DEBUG_PRINTLN(F("LED Effect: Streaming..."));
 
-    LEDEFFECT_DEBUG_PRINT(F("LED Effect: JSON Buffer "));
-    LEDEFFECT_DEBUG_PRINT(jsonBuffer.size());
-    LEDEFFECT_DEBUG_PRINT(F("/"));
-    LEDEFFECT_DEBUG_PRINTLN(_jsonBufferSize);
+    writer.beginObject();
+    writer.member("state", state ? "ON" : "OFF");
+    writer.member("brightness", brightness);
+    writer.member("brightness_rate", brightnessRate);
+    writer.member("fps", fps);
+    writer.member("min_fps", minFps);
+    writer.member("achieved_fps", (unsigned int)_stats.fps);
+    writer.member("transition", transition);
+    writer.key("effect");
+    writer.beginObject();
+    if (_effect) {
+      writer.member("name", (const char*)_effect->name);
+      _effect->serialize(writer);
+    }
+    writer.endObject();
+    writer.endObject();
+  }
 
-    return root.printTo(buffer, bufferSize);
+  size_t printTo(char* buffer, size_t bufferSize) {
+    BufferPrint print(buffer, bufferSize);
+    return printTo(print);
   }
 
   size_t printTo(Print& print) {
-    DynamicJsonBuffer jsonBuffer(_jsonBufferSize);
-    JsonObject& root = jsonBuffer.createObject();
-    serialize(root);
-
-    LEDEFFECT_DEBUG_PRINT(F("LED Effect: JSON Buffer "));
-    LEDEFFECT_DEBUG_PRINT(jsonBuffer.size());
-    LEDEFFECT_DEBUG_PRINT(F("/"));
-    LEDEFFECT_DEBUG_PRINTLN(_jsonBufferSize);
-
-    return root.printTo(print);
+    uint32_t start = micros();
+    JsonWriter writer(print);
+    serialize(writer);
+    _stats.serialize.add(micros() - start);
+    _stats.serializeBytes += writer.size();
+    return writer.size();
   }
 
   size_t printTo(String& str) {
-    DynamicJsonBuffer jsonBuffer(_jsonBufferSize);
-    JsonObject& root = jsonBuffer.createObject();
-    serialize(root);
+    StringPrint print(str);
+    return printTo(print);
+  }
 
-    LEDEFFECT_DEBUG_PRINT(F("LED Effect: JSON Buffer "));
-    LEDEFFECT_DEBUG_PRINT(jsonBuffer.size());
-    LEDEFFECT_DEBUG_PRINT(F("/"));
-    LEDEFFECT_DEBUG_PRINTLN(_jsonBufferSize);
+  // show the frames of receiver instead of rendering the effect, as soon as they are received, until there is none
+  // for ingestTimeout, 0 to stop
+  //
+  // Frames are received straight into the leds and shown at the brightness without waiting for the frame period,
+  // so loop() must be called as often as possible.
+  void ingest(DdpReceiver* receiver) {
+    _receiver = receiver;
+    if (!receiver && _ingesting) {
+      _ingesting = false;
+      invalidate();
+    }
+  }
 
-    return root.printTo(str);
+  // whether the frames shown are the ones of the receiver
+  bool ingesting() const {
+    return _ingesting;
   }
 
-  void loop() {
+  // render and show a frame, return whether a frame was shown
+  bool loop() {
+    if (_receiver) {
+      bool shown = false;
+      if (ingestFrame(shown))
+        return shown;
+    }
+
+    uint32_t now = micros();
+    uint8_t targetFps = this->targetFps();
+    uint32_t lateFrames = _scheduler.lateFrames;
+    uint32_t droppedFrames = _scheduler.droppedFrames;
+    if (!blocking) {
+      if (!_scheduler.due(now, targetFps))
+        return false;
+      _scheduler.start(now, targetFps);
+    }
+
+    // commands queued since the last frame
+    applyQueued();
+    notifyState();
+
 #ifdef LEDEFFECT_DEBUG
     auto startMillis = millis();
 #endif
 
-    // apply effect
-    _effects[_currentEffect]->loop();
+    // apply effect, static frames are skipped as the strip already shows them
+    bool rendered = render();
 
     // update strip
-    if (state) {
-      uint8_t currentBrightness = _fastLed.getBrightness();
-      if (currentBrightness < brightness)
-        _fastLed.setBrightness(currentBrightness + min((int)brightnessRate, brightness - currentBrightness));
-      else if (currentBrightness > brightness)
-        _fastLed.setBrightness(currentBrightness - min((int)brightnessRate, currentBrightness - brightness));
-    } else {
-      _fastLed.setBrightness(0);
+    if (rendered) {
+      uint32_t showStart = micros();
+      show();
+      _showMicros = micros() - showStart;
+      _stats.show.add(_showMicros);
+    }
+    if (minFps > 0) {
+      if (rendered)
+        _governor.measure(micros() - now);
+      _governor.update(activity(), min(minFps, fps), fps);
     }
-    _fastLed.show();
-    if (fps > 0)
-      _fastLed.delay(1000 / fps);
+    if (!blocking)
+      _scheduler.finish(micros());
+    else if (targetFps > 0 && rendered && !_sink && !outputStage)
+      _fastLed.delay(1000 / targetFps);
+    else if (targetFps > 0)
+      delay(1000 / targetFps);  // FastLED's delay would show the strip, raw when the output stage shows it
+    _stats.lateFrames += _scheduler.lateFrames - lateFrames;
+    _stats.droppedFrames += _scheduler.droppedFrames - droppedFrames;
 
+    // frames in the last second
+    _fpsFrames++;
+    if (now - _fpsStart >= 1000000UL) {
+      _stats.fps = (uint64_t)_fpsFrames * 1000000UL / (now - _fpsStart);
+      _fpsStart = now;
+      _fpsFrames = 0;
+    }
 
 #ifdef LEDEFFECT_DEBUG
     EVERY_N_SECONDS(10) {
       LEDEFFECT_DEBUG_PRINT(F("LED Effect: Loop time is "));
       LEDEFFECT_DEBUG_PRINT(millis() - startMillis);
       LEDEFFECT_DEBUG_PRINTLN(F("ms"));
+      if (!blocking) {
+        LEDEFFECT_DEBUG_PRINT(F("LED Effect: Late/dropped frames are "));
+        LEDEFFECT_DEBUG_PRINT(_scheduler.lateFrames);
+        LEDEFFECT_DEBUG_PRINT(F("/"));
+        LEDEFFECT_DEBUG_PRINT(_scheduler.droppedFrames);
+        LEDEFFECT_DEBUG_PRINT(F(" of "));
+        LEDEFFECT_DEBUG_PRINTLN(_scheduler.frames);
+      }
     }
 #endif
+
+    return rendered;
+  }
+
+  // render the frame at now and show it at once, even if it did not change, without waiting for the frame period
+  //
+  // With now advancing by the frame period, frames render faster than real time, e.g. into a FrameRecorder.
+  // Transitions still progress in real time.
+  void step(uint32_t now) {
+    render(now);
+    show();
+  }
+
+  // render the next frame and step the brightness, return false if the frame was skipped because it did not change
+  bool render() {
+    return render(micros());
+  }
+
+  // render the frame at now in microseconds
+  bool render(uint32_t now) {
+    if (!_effect)
+      return false;
+
+    // time goes on for skipped frames as well so that the next frame does not catch up
+    uint32_t start = micros();
+    uint32_t elapsed = _firstFrame ? FrameContext::RATE_PERIOD : now - _lastFrame;
+    uint8_t targetFps = this->targetFps();
+    FrameContext frame(now, elapsed, targetFps > 0 ? 1000000UL / targetFps : 0);
+    _lastFrame = now;
+    _firstFrame = false;
+
+    uint8_t nextBrightness = 0;
+    if (state) {
+      uint32_t step = frame.steps(brightnessRate, _brightnessRemainder);
+      if (_brightness < brightness)
+        nextBrightness = _brightness + min(step, (uint32_t)(brightness - _brightness));
+      else
+        nextBrightness = _brightness - min(step, (uint32_t)(_brightness - brightness));
+    }
+
+    if (skipStaticFrames && !_dirty && nextBrightness == _brightness && !_transition.active() &&
+        (_brightness == 0 || _effect->isStatic())) {
+      _stats.skippedFrames++;
+      return false;
+    }
+
+    if (_transition.active()) {
+      // what is left of the frame period after showing for both effects to render in
+      uint32_t period = frame.period > 0 ? frame.period : UINT32_MAX;
+      _transition.render(frame, period > _showMicros ? period - _showMicros : 0);
+      _renderMicros = _transition.incomingMicros();
+    } else {
+      _effect->loop(frame);
+      _renderMicros = micros() - start;
+    }
+    _stats.render.add(micros() - start);
+    if (_currentEffect < _stats.effectCount)
+      _stats.effects[_currentEffect].add(_renderMicros);
+    _stats.frames++;
+    _brightness = nextBrightness;
+    _dirty = false;
+    return true;
+  }
+
+  // copy the rendered frame to the controller at the current brightness, only for segments with a buffer
+  void compose() {
+    if (!_output)
+      return;
+
+    if (OutputStage* stage = this->stage()) {
+      stage->apply(_leds, _output, _size);
+      return;
+    }
+
+    for (uint16_t i = 0; i < _size; i++) {
+      _output[i] = _leds[i];
+    }
+    if (_brightness < 255)
+      ColorKernels::scale(_output, _size, _brightness);
+  }
+
+  CLEDController* controller() const {
+    return _controller;
+  }
+
+  // whether a crossfade between effects is running
+  bool transitioning() const {
+    return _transition.active();
+  }
+
+  // whether the frame is rendered in a buffer and copied to the controller by compose()
+  bool buffered() const {
+    return _output != 0;
+  }
+
+  // frame rate loop() runs at, adapted to the effect between minFps and fps when minFps is set
+  uint8_t targetFps() const {
+    return minFps > 0 && _governor.fps() > 0 ? _governor.fps() : fps;
+  }
+
+  // largest change of a channel per frame at LEDEFFECT_RATE_FPS, from the effect, the brightness ramp and the
+  // transition, see BaseEffect::activity()
+  uint8_t activity() const {
+    if (!_effect)
+      return 0;
+
+    uint8_t activity = _brightness > 0 ? _effect->activity() : 0;
+    if (_brightness != (state ? brightness : 0) && brightnessRate > activity)
+      activity = brightnessRate;
+    if (_transition.active()) {
+      uint32_t step = transition > 0 ? 255000UL / LEDEFFECT_RATE_FPS / transition : 255;
+      if (step > activity)
+        activity = step < 255 ? step : 255;
+    }
+    return activity;
+  }
+
+  // brightness of the last rendered frame
+  uint8_t currentBrightness() const {
+    return _brightness;
+  }
+
+  size_t jsonBufferSize() const {
+    return _jsonBufferSize;
+  }
+
+  // force the next frame to be rendered and shown, e.g. after writing to the leds
+  void invalidate() {
+    _dirty = true;
+  }
+
+  const FrameScheduler& scheduler() const {
+    return _scheduler;
+  }
+
+  // counters of the frames and commands since begin or the last reset
+  const Stats& stats() const {
+    return _stats;
+  }
+
+  void resetStats() {
+    _stats.reset();
+  }
+
+  void serializeStats(JsonObject& data) {
+    data["frames"] = _stats.frames;
+    data["skipped_frames"] = _stats.skippedFrames;
+    data["late_frames"] = _stats.lateFrames;
+    data["dropped_frames"] = _stats.droppedFrames;
+    data["ingested_frames"] = _stats.ingestedFrames;
+    data["fps"] = _stats.fps;
+    data["target_fps"] = targetFps();
+    _stats.render.serialize(data.createNestedObject("render"));
+    _stats.show.serialize(data.createNestedObject("show"));
+    _stats.deserialize.serialize(data.createNestedObject("deserialize"));
+    data["deserialize_bytes"] = _stats.deserializeBytes;
+    _stats.queue.serialize(data.createNestedObject("queue"));
+    _stats.serialize.serialize(data.createNestedObject("serialize"));
+    data["serialize_bytes"] = _stats.serializeBytes;
+    JsonObject& effects = data.createNestedObject("effects");
+    for (uint8_t i = 0; i < _stats.effectCount; i++)
+      _stats.effects[i].serialize(effects.createNestedObject(effectName(i)));
+    if (_sink) {
+      JsonObject& outputs = data.createNestedObject("outputs");
+      for (uint8_t i = 0; i < _stats.effectCount; i++)
+        _stats.outputs[i].serialize(outputs.createNestedObject(effectName(i)));
+    }
+  }
+
+  // stream the same JSON as serializeStats(JsonObject&)
+  void serializeStats(JsonWriter& writer) {
+    writer.beginObject();
+    writer.member("frames", _stats.frames);
+    writer.member("skipped_frames", _stats.skippedFrames);
+    writer.member("late_frames", _stats.lateFrames);
+    writer.member("dropped_frames", _stats.droppedFrames);
+    writer.member("ingested_frames", _stats.ingestedFrames);
+    writer.member("fps", (unsigned int)_stats.fps);
+    writer.member("target_fps", targetFps());
+    writer.key("render");
+    _stats.render.serialize(writer);
+    writer.key("show");
+    _stats.show.serialize(writer);
+    writer.key("deserialize");
+    _stats.deserialize.serialize(writer);
+    writer.member("deserialize_bytes", _stats.deserializeBytes);
+    writer.key("queue");
+    _stats.queue.serialize(writer);
+    writer.key("serialize");
+    _stats.serialize.serialize(writer);
+    writer.member("serialize_bytes", _stats.serializeBytes);
+    writer.key("effects");
+    writer.beginObject();
+    for (uint8_t i = 0; i < _stats.effectCount; i++) {
+      writer.key(effectName(i));
+      _stats.effects[i].serialize(writer);
+    }
+    writer.endObject();
+    if (_sink) {
+      writer.key("outputs");
+      writer.beginObject();
+      for (uint8_t i = 0; i < _stats.effectCount; i++) {
+        writer.key(effectName(i));
+        _stats.outputs[i].serialize(writer);
+      }
+      writer.endObject();
+    }
+    writer.endObject();
+  }
+
+  size_t printStatsTo(char* buffer, size_t bufferSize) {
+    BufferPrint print(buffer, bufferSize);
+    return printStatsTo(print);
+  }
+
+  size_t printStatsTo(Print& print) {
+    JsonWriter writer(print);
+    serializeStats(writer);
+    return writer.size();
+  }
+
+  size_t printStatsTo(String& str) {
+    StringPrint print(str);
+    return printStatsTo(print);
+  }
+
+  // size of the JSON buffer for serializeStats(JsonObject&)
+  size_t statsJsonBufferSize() const {
+    return JSON_OBJECT_SIZE(16) + 2 * JSON_OBJECT_SIZE(_stats.effectCount) +
+      (5 + _stats.effectCount) * DurationStats::jsonBufferSize() + _stats.effectCount * OutputStats::jsonBufferSize();
   }
 
 private:
   CLEDController* _controller;
+  CRGB* _leds;
+  uint16_t _size;
+  CRGB* _output = 0;
+  uint8_t _brightness = 0;
+  uint8_t _brightnessRemainder = 0;
+  uint32_t _lastFrame = 0;  // us
+  bool _firstFrame = true;
   CFastLED _fastLed;
-  BaseEffect** _effects;
-  uint8_t _effectCount;
+  OutputSink* _sink = 0;
+  CRGB* _front = 0;
+  BaseEffect** _effects = 0;
+  uint8_t _effectCount = 0;
+  EffectRegistry* _registry = 0;
+  BaseEffect* _effect = 0;
   uint8_t _currentEffect = 0;
-  size_t _jsonBufferSize = JSON_OBJECT_SIZE(5) + JSON_OBJECT_SIZE(1);  // root + effect
+  uint8_t* _scratch = 0;  // of the selected effect
+  size_t _scratchSize = 0;
+  uint8_t* _transitionScratch = 0;  // of the outgoing effect during a transition, allocated on the first one
+  Transition _transition;
+  uint32_t _renderMicros = 0;
+  uint32_t _showMicros = 0;
+  OutputStage* _stage = 0;
+  Stats _stats;
+  DdpReceiver* _receiver = 0;
+  CommandStage _commands;
+  bool _stateChanged = false;
+  bool _ingesting = false;
+  uint32_t _lastIngest = 0;  // ms
+  uint32_t _fpsStart = 0;
+  uint32_t _fpsFrames = 0;
+  FrameScheduler _scheduler;
+  FrameGovernor _governor;
+  bool _dirty = true;
+#ifdef LEDEFFECT_JSON_ARENA
+  JsonArena* _jsonArena = 0;
+#endif
+  size_t _jsonBufferSize = 0;
+  bool _segment = false;  // begun with beginSegment(), the group parses the commands
+
+#ifdef LEDEFFECT_JSON_ARENA
+  // the arena cleared for a command, allocated by begin() or, for a segment, by the first command given to it
+  JsonArena& jsonArena() {
+    // commands are parsed in place, only their nodes take room in the arena
+    if (!_jsonArena || _jsonArena->capacity() < _jsonBufferSize) {
+      delete _jsonArena;
+      _jsonArena = new JsonArena(_jsonBufferSize);
+    }
+    _jsonArena->clear();
+    return *_jsonArena;
+  }
+#endif
+
+  // show the frame of the receiver if one is complete, return false when there was none for ingestTimeout
+  //
+  // Until then the effect renders into the leds, over the packets of a frame received in between, so the packets
+  // are skipped up to the end of a frame and frames are received from the next one.
+  bool ingestFrame(bool& shown) {
+    if (!_ingesting) {
+      if (_receiver->receive(0, _size)) {
+        LEDEFFECT_DEBUG_PRINTLN(F("LED Effect: Receiving frames"));
+        _ingesting = true;
+        _lastIngest = millis();
+      }
+      return _ingesting;
+    }
+
+    if (_receiver->receive(_leds, _size)) {
+      applyQueued();
+      notifyState();
+      _lastIngest = millis();
+      _brightness = state ? brightness : 0;
+
+      uint32_t start = micros();
+      show();
+      _stats.show.add(micros() - start);
+      _stats.ingestedFrames++;
+      shown = true;
+    } else if (millis() - _lastIngest >= ingestTimeout) {
+      LEDEFFECT_DEBUG_PRINTLN(F("LED Effect: No frame received, back to the effect"));
+      _ingesting = false;
+      invalidate();
+    }
+    return _ingesting;
+  }
+
+  void queueField(uint8_t id, const uint8_t* value, uint8_t size) {
+    if (!_commands.set(id, value, size)) {
+      // full, the queued fields are applied to make room
+      applyQueued();
+      _commands.set(id, value, size);
+    }
+  }
+
+  void queueEffectField(uint8_t id, const uint8_t* value, uint8_t size) {
+    _commands.setEffect(_currentEffect);
+    queueField(id | CommandStage::EFFECT_FIELD, value, size);
+  }
+
+  bool queueBinary(const uint8_t* data, size_t size) {
+    for (size_t position = 0; position < size;) {
+      uint8_t id = data[position++];
+      if (id == CommandStage::EFFECT_ID) {
+        if (position >= size || data[position] >= effectCount())
+          return false;
+        if (!_effect || data[position] != _currentEffect) {
+          // the effect and its fields, applied at once
+          applyQueued();
+          return deserialize(data + position - 1, size - position + 1);
+        }
+        position++;
+
+        const ParameterTable& table = _effect->parameters();
+        while (position < size) {
+          const Parameter* parameter = table.at(data[position]);
+          uint8_t valueSize = parameter ? parameter->binarySize(data + position + 1, size - position - 1) : 0;
+          if (!valueSize || data[position] >= CommandStage::EFFECT_FIELD)
+            return false;
+          queueEffectField(data[position], data + position + 1, valueSize);
+          position += 1 + valueSize;
+        }
+        return true;
+      }
+
+      uint8_t valueSize = id == 6 ? 2 : 1;
+      if (id == 0 || id > 7 || size - position < valueSize)
+        return false;
+      queueField(id, data + position, valueSize);
+      position += valueSize;
+    }
+    return true;
+  }
+
+  void show() {
+    OutputStage* stage = this->stage();
+    if (!_sink) {
+      // the output stage shows this controller only, from a buffer as the leds are kept for the effect
+      CRGB* buffer = stage ? stage->buffer(_size) : 0;
+      if (buffer) {
+        stage->apply(_leds, buffer, _size);
+        _controller->show(buffer, _size, 255);
+        return;
+      }
+      _fastLed.setBrightness(_brightness);
+      _fastLed.show();
+      return;
+    }
+
+    // wait for the sink to be done with the previous frame
+    while (!_sink->ready())
+      yield();
+
+    CRGB* buffer = stage ? (_front ? _front : stage->buffer(_size)) : 0;
+    if (buffer) {
+      stage->apply(_leds, buffer, _size);
+      _sink->show(buffer, _size, 255);
+    } else if (_front) {
+      memcpy(_front, _leds, _size * sizeof(CRGB));
+      _sink->show(_front, _size, _brightness);
+    } else {
+      _sink->show(_leds, _size, _brightness);
+    }
+    if (_currentEffect < _stats.effectCount && !_ingesting)
+      _stats.outputs[_currentEffect].add(_sink->packets(), _sink->bytes());
+  }
+
+  // the output stage with its tables up to date, 0 if disabled
+  OutputStage* stage() {
+    if (!outputStage)
+      return 0;
+    if (!_stage)
+      _stage = new OutputStage();
+    _stage->update(gamma, _brightness, whiteBalance);
+    return _stage;
+  }
+
+  uint8_t effectCount() const {
+    return _registry ? _registry->size() : _effectCount;
+  }
+
+  const char* effectName(uint8_t index) const {
+    return _registry ? _registry->name(index) : _effects[index]->name;
+  }
+
+  // index of the effect named name, -1 if there is none
+  int16_t findEffect(const char* name) const {
+    if (_registry)
+      return _registry->find(name);
+
+    for (uint8_t i = 0; i < _effectCount; i++) {
+      if (strcmp(name, _effects[i]->name) == 0)
+        return i;
+    }
+    return -1;
+  }
+
+  // switch to the effect at index, constructing it when effects come from a registry, and lend it the scratch memory
+  //
+  // With a transition the outgoing effect keeps rendering if it is still in memory and, when it uses scratch memory,
+  // a second scratch memory can be allocated, otherwise its last frame is faded out.
+  void selectEffect(uint8_t index) {
+    if (_effect && index == _currentEffect)
+      return;
+
+    _transition.cancel();
+    bool switching = _effect != 0;
+    BaseEffect* outgoing = _registry ? 0 : _effect;
+    bool live = outgoing && (outgoing->scratchSize() == 0 || swapScratch());
+
+    _currentEffect = index;
+    if (_registry) {
+      _effect = _registry->select(index);
+      if (!_effect)
+        return;
+      _effect->begin(_leds, _size);
+    } else {
+      _effect = _effects[index];
+    }
+
+    if (_effect->scratchSize() > _scratchSize) {
+      LEDEFFECT_DEBUG_PRINTLN(F("LEDEffect: Not enough scratch memory"));
+      _effect->activate(0);
+    } else {
+      if (_scratch)
+        memset(_scratch, 0, _effect->scratchSize());
+      _effect->activate(_scratch);
+    }
+
+    if (transition > 0 && switching)
+      _transition.start(outgoing, live, _effect, _leds, _size, transition, _renderMicros);
+  }
+
+  // give the selected effect's scratch memory to the outgoing effect of a transition, return false if out of memory
+  bool swapScratch() {
+    if (transition == 0)
+      return false;
+    if (!_transitionScratch) {
+      _transitionScratch = (uint8_t*)malloc(_scratchSize);
+      if (!_transitionScratch) {
+        LEDEFFECT_DEBUG_PRINTLN(F("LEDEffect: Not enough memory to render both effects of a transition"));
+        return false;
+      }
+    }
+    uint8_t* scratch = _scratch;
+    _scratch = _transitionScratch;
+    _transitionScratch = scratch;
+    return true;
+  }
+
+  void beginEffects(CRGB* leds, uint16_t size) {
+    _transition.cancel();
+    _leds = leds;
+    _size = size;
+    _brightness = brightness;
+    _dirty = true;
+    _firstFrame = true;
+
+    size_t maxEffectJsonBufferSize = 0;
+    size_t maxScratchSize = 0;
+    if (_registry) {
+      _registry->begin(_leds, _size);
+      maxEffectJsonBufferSize = _registry->jsonBufferSize();
+      maxScratchSize = _registry->scratchSize();
+    } else {
+      for (uint8_t i = 0; i < _effectCount; i++) {
+        _effects[i]->begin(_leds, _size);
+        if (_effects[i]->jsonBufferSize() > maxEffectJsonBufferSize)
+          maxEffectJsonBufferSize = _effects[i]->jsonBufferSize();
+        if (_effects[i]->scratchSize() > maxScratchSize)
+          maxScratchSize = _effects[i]->scratchSize();
+      }
+    }
+
+    // one scratch memory for the effects, only the selected one uses it
+    if (maxScratchSize > _scratchSize) {
+      free(_scratch);
+      free(_transitionScratch);
+      _transitionScratch = 0;
+      _scratch = (uint8_t*)malloc(maxScratchSize);
+      _scratchSize = _scratch ? maxScratchSize : 0;
+    }
+    if (effectCount() > _stats.effectCount) {
+      delete[] _stats.effects;
+      delete[] _stats.outputs;
+      _stats.effects = new DurationStats[effectCount()];
+      _stats.outputs = new OutputStats[effectCount()];
+      _stats.effectCount = effectCount();
+    }
+
+    LEDEFFECT_DEBUG_PRINT(F("LEDEffect: Scratch memory is "));
+    LEDEFFECT_DEBUG_PRINTLN(_scratchSize);
+    _effect = 0;
+    selectEffect(_currentEffect);
+
+    size_t baseJsonBufferSize = JSON_OBJECT_SIZE(8) + JSON_OBJECT_SIZE(1);  // root + effect
+    LEDEFFECT_DEBUG_PRINT(F("LEDEffect: JSON buffer size is "));
+    LEDEFFECT_DEBUG_PRINT(baseJsonBufferSize);
+    LEDEFFECT_DEBUG_PRINT(F(" (base) + "));
+    LEDEFFECT_DEBUG_PRINT(maxEffectJsonBufferSize);
+    LEDEFFECT_DEBUG_PRINT(F(" (effects) = "));
+    LEDEFFECT_DEBUG_PRINTLN(baseJsonBufferSize + maxEffectJsonBufferSize);
+
+    _jsonBufferSize = baseJsonBufferSize + maxEffectJsonBufferSize;
+
+#ifdef LEDEFFECT_JSON_ARENA
+    // segments share the arena of their group
+    if (!_segment)
+      jsonArena();
+#endif
+  }
 };
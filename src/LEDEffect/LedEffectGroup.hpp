@@ -0,0 +1,197 @@
+#pragma once
+
+#include <ArduinoJson.h>
+#include <FastLED.h>
+
+#include "Configuration.hpp"
+#include "FrameScheduler.hpp"
+#include "JsonArena.hpp"
+#include "LEDEffect.hpp"
+
+// Segments with independent effects, brightness and state, rendered together and shown once per frame
+//
+// Each segment is a LedEffect with its own effects begun with beginSegment(), either on a whole controller
+// or on a range of a controller with a buffer of its own to render into. Segments with a buffer are copied
+// to their controller at their brightness, other segments use the brightness of their controller.
+// The fps and blocking settings of the group apply, those of the segments are ignored. Commands queued to the
+// segments are applied at the next frame of the group.
+class LedEffectGroup
+{
+public:
+  uint8_t fps = 30;
+  bool blocking = true;  // wait for the frame period in loop(), set to false to return at once when no frame is due
+
+  LedEffectGroup(LedEffect** segments, uint8_t segmentCount) : _segments(segments), _segmentCount(segmentCount) { };
+
+#ifdef LEDEFFECT_JSON_ARENA
+  ~LedEffectGroup() {
+    delete _jsonArena;
+  }
+#endif
+
+  // the group owns its JSON arena
+  LedEffectGroup(const LedEffectGroup&) = delete;
+  LedEffectGroup& operator=(const LedEffectGroup&) = delete;
+
+  // call after beginning every segment
+  void begin() {
+    size_t maxSegmentJsonBufferSize = 0;
+    for (uint8_t i = 0; i < _segmentCount; i++) {
+      if (_segments[i]->jsonBufferSize() > maxSegmentJsonBufferSize)
+        maxSegmentJsonBufferSize = _segments[i]->jsonBufferSize();
+    }
+    _jsonBufferSize = JSON_NODE_SIZE + maxSegmentJsonBufferSize;  // segment + largest segment
+
+#ifdef LEDEFFECT_JSON_ARENA
+    // the one arena of the group and its segments, commands given to the group are parsed in it
+    if (!_jsonArena || _jsonArena->capacity() < _jsonBufferSize) {
+      delete _jsonArena;
+      _jsonArena = new JsonArena(_jsonBufferSize);
+    }
+#endif
+  }
+
+  LedEffect& segment(uint8_t index) {
+    return *_segments[index];
+  }
+
+  uint8_t segmentCount() const {
+    return _segmentCount;
+  }
+
+  // deserialize a command to the segment given by its "segment" index, the first one if missing
+  bool deserialize(JsonObject& root) {
+    LedEffect* segment = segmentOf(root);
+    return segment && segment->deserialize(root);
+  }
+
+  bool deserialize(char* data) {
+#ifdef LEDEFFECT_JSON_ARENA
+    JsonArena& jsonBuffer = *_jsonArena;
+    jsonBuffer.clear();
+#else
+    DynamicJsonBuffer jsonBuffer(_jsonBufferSize);
+#endif
+    JsonObject& root = jsonBuffer.parseObject(data);
+
+    return deserialize(root);
+  }
+
+  // apply a binary command to the segment given by its index in the first byte, see LedEffect for the command
+  bool deserialize(const uint8_t* data, size_t size) {
+    LedEffect* segment = segmentOf(data, size);
+    return segment && segment->deserialize(data + 1, size - 1);
+  }
+
+  // queue a command to the segment given by its "segment" index to apply at the next frame, see LedEffect::queue()
+  bool queue(JsonObject& root) {
+    LedEffect* segment = segmentOf(root);
+    return segment && segment->queue(root);
+  }
+
+  bool queue(char* data) {
+#ifdef LEDEFFECT_JSON_ARENA
+    JsonArena& jsonBuffer = *_jsonArena;
+    jsonBuffer.clear();
+#else
+    DynamicJsonBuffer jsonBuffer(_jsonBufferSize);
+#endif
+    JsonObject& root = jsonBuffer.parseObject(data);
+
+    return queue(root);
+  }
+
+  // queue a binary command to the segment given by its index in the first byte
+  bool queue(const uint8_t* data, size_t size) {
+    LedEffect* segment = segmentOf(data, size);
+    return segment && segment->queue(data + 1, size - 1);
+  }
+
+  // render every segment and show them at once, return whether a frame was shown
+  bool loop() {
+    if (!blocking) {
+      uint32_t now = micros();
+      if (!_scheduler.due(now, fps))
+        return false;
+      _scheduler.start(now, fps);
+    }
+
+    // commands queued since the last frame
+    for (uint8_t i = 0; i < _segmentCount; i++) {
+      _segments[i]->applyQueued();
+      _segments[i]->notifyState();
+    }
+
+    // render
+    bool rendered = false;
+    for (uint8_t i = 0; i < _segmentCount; i++) {
+      if (_segments[i]->render()) {
+        _segments[i]->compose();
+        rendered = true;
+      }
+    }
+
+    // show
+    if (rendered)
+      show();
+
+    if (!blocking)
+      _scheduler.finish(micros());
+    else if (fps > 0)
+      delay(1000 / fps);  // FastLED's delay would show the strips at the global brightness
+
+    return rendered;
+  }
+
+  const FrameScheduler& scheduler() const {
+    return _scheduler;
+  }
+
+private:
+  LedEffect** _segments;
+  uint8_t _segmentCount;
+  FrameScheduler _scheduler;
+  size_t _jsonBufferSize = 0;
+#ifdef LEDEFFECT_JSON_ARENA
+  JsonArena* _jsonArena = 0;
+#endif
+
+  // the segment given by the "segment" index of a command, the first one if missing, 0 if there is none
+  LedEffect* segmentOf(JsonObject& root) {
+    if (!root.success()) {
+      LEDEFFECT_DEBUG_PRINTLN(F("LED Effect Group: JSON Parse failed"));
+      return 0;
+    }
+
+    uint8_t index = root["segment"].as<uint8_t>();
+    if (index >= _segmentCount) {
+      LEDEFFECT_DEBUG_PRINT(F("LED Effect Group: Unknown segment "));
+      LEDEFFECT_DEBUG_PRINTLN(index);
+      return 0;
+    }
+    return _segments[index];
+  }
+
+  // the segment given by the first byte of a binary command, 0 if there is none
+  LedEffect* segmentOf(const uint8_t* data, size_t size) {
+    if (size < 1 || data[0] >= _segmentCount) {
+      LEDEFFECT_DEBUG_PRINTLN(F("LED Effect Group: Unknown segment"));
+      return 0;
+    }
+    return _segments[data[0]];
+  }
+
+  // show every controller, at the brightness of its segment when the segment renders into it directly
+  void show() {
+    for (CLEDController* controller = CLEDController::head(); controller; controller = controller->next()) {
+      uint8_t brightness = 255;
+      for (uint8_t i = 0; i < _segmentCount; i++) {
+        if (_segments[i]->controller() == controller && !_segments[i]->buffered()) {
+          brightness = _segments[i]->currentBrightness();
+          break;
+        }
+      }
+      controller->showLeds(brightness);
+    }
+  }
+};
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <FastLED.h>
+
+#ifdef ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#define LEDEFFECT_THREADED_SINK
+#elif defined(ARDUINO_ARCH_HOST)
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#define LEDEFFECT_THREADED_SINK
+#endif
+
+// Destination of the rendered frames
+class OutputSink
+{
+public:
+  virtual ~OutputSink() { };
+
+  // output size leds at brightness, leds must stay untouched until ready() returns true
+  virtual void show(const CRGB* leds, uint16_t size, uint8_t brightness) = 0;
+
+  // whether the sink is done with the leds of the last show()
+  virtual bool ready() {
+    return true;
+  }
+
+  // packets the last show() sent, for sinks that output over a network
+  virtual uint16_t packets() const {
+    return 0;
+  }
+
+  // bytes the last show() sent, headers included, for sinks that output over a network
+  virtual uint32_t bytes() const {
+    return 0;
+  }
+};
+
+// Output to a FastLED controller
+class ControllerSink : public OutputSink
+{
+public:
+  ControllerSink(CLEDController* controller) : _controller(controller) { };
+
+  void show(const CRGB* leds, uint16_t size, uint8_t brightness) override {
+    _controller->show(leds, size, brightness);
+  }
+
+protected:
+  CLEDController* _controller;
+};
+
+#ifdef ESP32
+// Output to another sink from a task of its own so that the next frame renders while this one is output
+class ThreadedSink : public OutputSink
+{
+public:
+  ThreadedSink(OutputSink* sink) : _sink(sink) { };
+
+  // start the output task, by default on the core the Arduino loop does not run on
+  void begin(BaseType_t core = 0, UBaseType_t priority = 2) {
+    _start = xSemaphoreCreateBinary();
+    xTaskCreatePinnedToCore(run, "LEDEffect", 2048, this, priority, 0, core);
+  }
+
+  void show(const CRGB* leds, uint16_t size, uint8_t brightness) override {
+    _leds = leds;
+    _size = size;
+    _brightness = brightness;
+    _busy = true;
+    xSemaphoreGive(_start);
+  }
+
+  bool ready() override {
+    return !_busy;
+  }
+
+  // of the last frame the task finished, which can be the one before the last show()
+  uint16_t packets() const override {
+    return _sink->packets();
+  }
+
+  uint32_t bytes() const override {
+    return _sink->bytes();
+  }
+
+protected:
+  OutputSink* _sink;
+  SemaphoreHandle_t _start;
+  const CRGB* _leds;
+  uint16_t _size;
+  uint8_t _brightness;
+  volatile bool _busy = false;
+
+  static void run(void* parameter) {
+    ThreadedSink* self = (ThreadedSink*)parameter;
+    for (;;) {
+      xSemaphoreTake(self->_start, portMAX_DELAY);
+      self->_sink->show(self->_leds, self->_size, self->_brightness);
+      self->_busy = false;
+    }
+  }
+};
+#elif defined(ARDUINO_ARCH_HOST)
+// Output to another sink from a thread of its own so that the next frame renders while this one is output
+class ThreadedSink : public OutputSink
+{
+public:
+  ThreadedSink(OutputSink* sink) : _sink(sink) { };
+
+  ~ThreadedSink() {
+    if (!_thread.joinable())
+      return;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _wake.notify_one();
+    _thread.join();
+  }
+
+  // start the output thread
+  void begin() {
+    if (!_thread.joinable())
+      _thread = std::thread(run, this);
+  }
+
+  void show(const CRGB* leds, uint16_t size, uint8_t brightness) override {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _leds = leds;
+      _size = size;
+      _brightness = brightness;
+      _busy = true;
+    }
+    _wake.notify_one();
+  }
+
+  bool ready() override {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return !_busy;
+  }
+
+  // of the last frame the thread finished, which can be the one before the last show()
+  uint16_t packets() const override {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _packets;
+  }
+
+  uint32_t bytes() const override {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _bytes;
+  }
+
+protected:
+  OutputSink* _sink;
+  std::thread _thread;
+  mutable std::mutex _mutex;
+  std::condition_variable _wake;
+  const CRGB* _leds = 0;
+  uint16_t _size = 0;
+  uint8_t _brightness = 0;
+  uint16_t _packets = 0;
+  uint32_t _bytes = 0;
+  bool _busy = false;
+  bool _stop = false;
+
+  static void run(ThreadedSink* self) {
+    std::unique_lock<std::mutex> lock(self->_mutex);
+    for (;;) {
+      self->_wake.wait(lock, [self]() { return self->_busy || self->_stop; });
+      if (self->_stop)
+        return;
+      const CRGB* leds = self->_leds;
+      uint16_t size = self->_size;
+      uint8_t brightness = self->_brightness;
+      lock.unlock();
+      self->_sink->show(leds, size, brightness);
+      uint16_t packets = self->_sink->packets();
+      uint32_t bytes = self->_sink->bytes();
+      lock.lock();
+      self->_packets = packets;
+      self->_bytes = bytes;
+      self->_busy = false;
+    }
+  }
+};
+#endif
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <math.h>
+
+// Gamma, brightness and white balance applied to the leds in a single pass through a lookup table per channel
+//
+// Gamma is applied to the leds scaled by brightness, so that brightness ramps in steps that look even, through a
+// 16 bit gamma table interpolated between the 256 entries. White balance then scales each channel. The tables are
+// rebuilt by update() only when a parameter changed, the gamma table only when gamma changed.
+class OutputStage
+{
+public:
+  ~OutputStage() {
+    free(_buffer);
+  }
+
+  // rebuild the tables if a parameter changed
+  void update(float gamma, uint8_t brightness, const CRGB& whiteBalance) {
+    if (_valid && gamma == _gamma && brightness == _brightness && whiteBalance == _whiteBalance)
+      return;
+
+    if (!_valid || gamma != _gamma) {
+      for (uint16_t i = 0; i < 256; i++)
+        _gammaTable[i] = pow(i / 255.0f, gamma) * 65535.0f + 0.5f;
+    }
+
+    for (uint16_t i = 0; i < 256; i++) {
+      // gamma of i * brightness / 255 between the entries of the gamma table
+      uint16_t scaled = i * brightness;
+      uint8_t index = scaled / 255;
+      uint8_t fraction = scaled % 255;
+      uint32_t value = _gammaTable[index];
+      if (fraction)
+        value += ((uint32_t)(_gammaTable[index + 1] - _gammaTable[index]) * fraction + 127) / 255;
+
+      for (uint8_t channel = 0; channel < 3; channel++)
+        _tables[channel][i] = (value * whiteBalance.raw[channel] + 32767) / 65535;
+    }
+
+    _gamma = gamma;
+    _brightness = brightness;
+    _whiteBalance = whiteBalance;
+    _valid = true;
+  }
+
+  // out = tables of in, which can be the same leds
+  void apply(const CRGB* in, CRGB* out, uint16_t count) const {
+    for (uint16_t i = 0; i < count; i++) {
+      out[i].r = _tables[0][in[i].r];
+      out[i].g = _tables[1][in[i].g];
+      out[i].b = _tables[2][in[i].b];
+    }
+  }
+
+  // buffer of size leds to apply into for outputs that show the leds they are given, 0 if out of memory
+  CRGB* buffer(uint16_t size) {
+    if (size > _bufferSize) {
+      free(_buffer);
+      _buffer = (CRGB*)malloc(size * sizeof(CRGB));
+      _bufferSize = _buffer ? size : 0;
+    }
+    return _buffer;
+  }
+
+private:
+  uint8_t _tables[3][256];
+  uint16_t _gammaTable[256];
+  float _gamma = 0;
+  uint8_t _brightness = 0;
+  CRGB _whiteBalance;
+  bool _valid = false;
+  CRGB* _buffer = 0;
+  uint16_t _bufferSize = 0;
+};
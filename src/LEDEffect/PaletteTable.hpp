@@ -0,0 +1,31 @@
+#pragma once
+
+#include <FastLED.h>
+
+// A palette expanded to all of its 256 colors so that looking up a color is a single load
+class PaletteTable
+{
+public:
+  // expand the palette, table indices 0-255 are mapped to palette indices 0-maxIndex
+  void build(const CRGBPalette16& palette, TBlendType blend, uint8_t maxIndex = 255) {
+    for (uint16_t i = 0; i < 256; i++) {
+      _colors[i] = ColorFromPalette(palette, maxIndex == 255 ? i : scale8(i, maxIndex), 255, blend);
+    }
+  }
+
+  const CRGB& operator[](uint8_t index) const {
+    return _colors[index];
+  }
+
+  // same as fill_palette at full brightness
+  void fill(CRGB* leds, uint16_t count, uint8_t startIndex, uint8_t incIndex) const {
+    uint8_t index = startIndex;
+    for (uint16_t i = 0; i < count; i++) {
+      leds[i] = _colors[index];
+      index += incIndex;
+    }
+  }
+
+private:
+  CRGB _colors[256];
+};
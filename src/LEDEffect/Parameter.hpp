@@ -0,0 +1,220 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <FastLED.h>
+
+#include "PaletteData.hpp"
+
+// Slots of the name index of a ParameterTable, a power of two at least twice the parameters of any effect
+#ifndef LEDEFFECT_PARAMETER_INDEX_SIZE
+#define LEDEFFECT_PARAMETER_INDEX_SIZE 16
+#endif
+
+class BaseEffect;
+
+// FNV-1a hash of a parameter or effect name
+inline uint32_t nameHash(const char* name) {
+  uint32_t hash = 2166136261UL;
+  while (*name)
+    hash = (hash ^ (uint8_t)*name++) * 16777619UL;
+  return hash;
+}
+
+enum ParameterType : uint8_t {
+  PARAMETER_UINT8,   // JSON number, 1 byte
+  PARAMETER_INT8,    // JSON number, 1 byte
+  PARAMETER_BOOL,    // JSON boolean, 1 byte
+  PARAMETER_BLEND,   // JSON boolean, 1 byte, a TBlendType
+  PARAMETER_RGB,     // JSON [red, green, blue], 3 bytes, a CRGB
+  PARAMETER_HSV,     // JSON [hue, saturation, value], 3 bytes, to a CRGB, write only
+  PARAMETER_PALETTE  // JSON string, a length byte followed by the characters, a palette name
+};
+
+// A setting of an effect, declared once in the table of the effect for deserialize and serialize to use
+//
+// Members are given as pointers to members of the effect class, e.g. &TwinkleEffect::density.
+struct Parameter
+{
+  const char* name;
+  uint32_t hash;
+  ParameterType type;
+  int16_t min;  // range of the integer types, values are clamped to it
+  int16_t max;
+  union Member {
+    uint8_t BaseEffect::* uint8;
+    int8_t BaseEffect::* int8;
+    bool BaseEffect::* boolean;
+    TBlendType BaseEffect::* blend;
+    CRGB BaseEffect::* color;
+    char (BaseEffect::* palette)[LEDEFFECT_PALETTE_NAME_MAX_LENGTH];
+
+    Member(uint8_t BaseEffect::* member) : uint8(member) { };
+    Member(int8_t BaseEffect::* member) : int8(member) { };
+    Member(bool BaseEffect::* member) : boolean(member) { };
+    Member(TBlendType BaseEffect::* member) : blend(member) { };
+    Member(CRGB BaseEffect::* member) : color(member) { };
+    Member(char (BaseEffect::* member)[LEDEFFECT_PALETTE_NAME_MAX_LENGTH]) : palette(member) { };
+  } member;
+
+  template<class E>
+  Parameter(const char* name, uint8_t E::* member, uint8_t min = 0, uint8_t max = 255) :
+    name(name), hash(nameHash(name)), type(PARAMETER_UINT8), min(min), max(max),
+    member(static_cast<uint8_t BaseEffect::*>(member)) { };
+
+  template<class E>
+  Parameter(const char* name, int8_t E::* member, int8_t min = -128, int8_t max = 127) :
+    name(name), hash(nameHash(name)), type(PARAMETER_INT8), min(min), max(max),
+    member(static_cast<int8_t BaseEffect::*>(member)) { };
+
+  template<class E>
+  Parameter(const char* name, bool E::* member) :
+    name(name), hash(nameHash(name)), type(PARAMETER_BOOL), min(0), max(1),
+    member(static_cast<bool BaseEffect::*>(member)) { };
+
+  template<class E>
+  Parameter(const char* name, TBlendType E::* member) :
+    name(name), hash(nameHash(name)), type(PARAMETER_BLEND), min(0), max(1),
+    member(static_cast<TBlendType BaseEffect::*>(member)) { };
+
+  // type is PARAMETER_RGB or PARAMETER_HSV
+  template<class E>
+  Parameter(const char* name, CRGB E::* member, ParameterType type = PARAMETER_RGB) :
+    name(name), hash(nameHash(name)), type(type), min(0), max(255),
+    member(static_cast<CRGB BaseEffect::*>(member)) { };
+
+  template<class E>
+  Parameter(const char* name, char (E::* member)[LEDEFFECT_PALETTE_NAME_MAX_LENGTH]) :
+    name(name), hash(nameHash(name)), type(PARAMETER_PALETTE), min(0), max(0),
+    member(static_cast<char (BaseEffect::*)[LEDEFFECT_PALETTE_NAME_MAX_LENGTH]>(member)) { };
+
+  // clamp a value to the range
+  long clamp(long value) const {
+    return value < min ? min : value > max ? max : value;
+  }
+
+  // whether serialize writes the parameter
+  bool readable() const {
+    return type != PARAMETER_HSV;
+  }
+
+  // write the binary value of a JSON value into data of LEDEFFECT_PALETTE_NAME_MAX_LENGTH bytes, the value
+  // deserializing to what the JSON one does, return its size, 0 if the JSON value is invalid
+  uint8_t encode(const JsonVariant& value, uint8_t* data) const {
+    switch (type) {
+      case PARAMETER_UINT8:
+      case PARAMETER_INT8:
+        data[0] = (uint8_t)clamp(value.as<long>());
+        return 1;
+      case PARAMETER_BOOL:
+      case PARAMETER_BLEND:
+        data[0] = value.as<bool>();
+        return 1;
+      case PARAMETER_RGB:
+      case PARAMETER_HSV:
+        for (uint8_t i = 0; i < 3; i++)
+          data[i] = value[i].as<uint8_t>();
+        return 3;
+      case PARAMETER_PALETTE: {
+        const char* string = value.as<const char*>();
+        if (!string)
+          return 0;
+        uint8_t length = strnlen(string, LEDEFFECT_PALETTE_NAME_MAX_LENGTH - 1);
+        data[0] = length;
+        memcpy(data + 1, string, length);
+        return 1 + length;
+      }
+    }
+    return 0;
+  }
+
+  // size of the binary value at the start of data, 0 if it is truncated or invalid
+  uint8_t binarySize(const uint8_t* data, size_t size) const {
+    uint8_t valueSize = 1;
+    if (type == PARAMETER_RGB || type == PARAMETER_HSV)
+      valueSize = 3;
+    else if (type == PARAMETER_PALETTE && size > 0) {
+      if (data[0] >= LEDEFFECT_PALETTE_NAME_MAX_LENGTH)
+        return 0;
+      valueSize = 1 + data[0];
+    }
+    return valueSize <= size ? valueSize : 0;
+  }
+};
+
+// The parameters of an effect, following the parameters of the effect it derives from
+//
+// Parameters are numbered from 1, starting with those of the base table, which is also the order of serialize.
+// Names are looked up through an index of all of them, built when the table is, with open addressing and
+// linear probing at most half full; a table too large for it is scanned instead.
+struct ParameterTable
+{
+  const Parameter* parameters;
+  uint8_t count;
+  const ParameterTable* base;
+  uint8_t index[LEDEFFECT_PARAMETER_INDEX_SIZE];  // parameter numbers, 0 for an empty slot
+
+  ParameterTable(const Parameter* parameters, uint8_t count, const ParameterTable* base = 0) :
+    parameters(parameters), count(count), base(base) {
+    memset(index, 0, sizeof(index));
+    if (indexed()) {
+      for (uint8_t i = 1; i <= size(); i++) {
+        uint8_t slot = at(i)->hash & (LEDEFFECT_PARAMETER_INDEX_SIZE - 1);
+        while (index[slot])
+          slot = (slot + 1) & (LEDEFFECT_PARAMETER_INDEX_SIZE - 1);
+        index[slot] = i;
+      }
+    }
+  };
+
+  uint8_t size() const {
+    return (base ? base->size() : 0) + count;
+  }
+
+  // parameter by number, 0 if there is none
+  const Parameter* at(uint8_t number) const {
+    uint8_t baseSize = base ? base->size() : 0;
+    if (number <= baseSize)
+      return base ? base->at(number) : 0;
+    if (number - baseSize > count)
+      return 0;
+    return &parameters[number - baseSize - 1];
+  }
+
+  // number of the parameter with name, 0 if there is none
+  uint8_t number(const char* name) const {
+    return number(name, nameHash(name));
+  }
+
+  uint8_t number(const char* name, uint32_t hash) const {
+    if (!indexed()) {
+      for (uint8_t i = 1; i <= size(); i++) {
+        const Parameter* parameter = at(i);
+        if (parameter->hash == hash && strcmp(parameter->name, name) == 0)
+          return i;
+      }
+      return 0;
+    }
+    for (uint8_t slot = hash & (LEDEFFECT_PARAMETER_INDEX_SIZE - 1); index[slot];
+         slot = (slot + 1) & (LEDEFFECT_PARAMETER_INDEX_SIZE - 1)) {
+      const Parameter* parameter = at(index[slot]);
+      if (parameter->hash == hash && strcmp(parameter->name, name) == 0)
+        return index[slot];
+    }
+    return 0;
+  }
+
+  // parameter by name, 0 if there is none
+  const Parameter* find(const char* name) const {
+    return find(name, nameHash(name));
+  }
+
+  const Parameter* find(const char* name, uint32_t hash) const {
+    return at(number(name, hash));
+  }
+
+private:
+  bool indexed() const {
+    return 2 * size() <= LEDEFFECT_PARAMETER_INDEX_SIZE;
+  }
+};
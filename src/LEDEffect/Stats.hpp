@@ -0,0 +1,149 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include "JsonWriter.hpp"
+
+#ifndef LEDEFFECT_STATS_BUCKETS
+#define LEDEFFECT_STATS_BUCKETS 12
+#endif
+
+// Durations in microseconds with a histogram in power of two buckets
+//
+// Bucket 0 counts durations under 32us, bucket i under 32us << i and the last bucket the longer ones, so that
+// 12 buckets go up to 65ms. Buckets saturate at 65535.
+struct DurationStats
+{
+  uint32_t count = 0;
+  uint32_t last = 0;
+  uint32_t max = 0;
+  uint64_t total = 0;
+  uint16_t buckets[LEDEFFECT_STATS_BUCKETS] = {};
+
+  void add(uint32_t micros) {
+    count++;
+    last = micros;
+    total += micros;
+    if (micros > max)
+      max = micros;
+
+    uint8_t bucket = 0;
+    for (uint32_t limit = 32; bucket < LEDEFFECT_STATS_BUCKETS - 1 && micros >= limit; limit <<= 1)
+      bucket++;
+    if (buckets[bucket] < 0xFFFF)
+      buckets[bucket]++;
+  }
+
+  uint32_t mean() const {
+    return count ? total / count : 0;
+  }
+
+  void reset() {
+    *this = DurationStats();
+  }
+
+  void serialize(JsonObject& data) const {
+    data["count"] = count;
+    data["mean"] = mean();
+    data["max"] = max;
+    data["last"] = last;
+    JsonArray& histogram = data.createNestedArray("histogram");
+    for (uint8_t i = 0; i < LEDEFFECT_STATS_BUCKETS; i++)
+      histogram.add(buckets[i]);
+  }
+
+  void serialize(JsonWriter& writer) const {
+    writer.beginObject();
+    writer.member("count", count);
+    writer.member("mean", mean());
+    writer.member("max", max);
+    writer.member("last", last);
+    writer.key("histogram");
+    writer.beginArray();
+    for (uint8_t i = 0; i < LEDEFFECT_STATS_BUCKETS; i++)
+      writer.value((unsigned int)buckets[i]);
+    writer.endArray();
+    writer.endObject();
+  }
+
+  // size of the JSON buffer for serialize(JsonObject&)
+  static constexpr size_t jsonBufferSize() {
+    return JSON_OBJECT_SIZE(5) + JSON_ARRAY_SIZE(LEDEFFECT_STATS_BUCKETS);
+  }
+};
+
+// Packets and bytes sent to an OutputSink over a network, see OutputSink::packets()
+struct OutputStats
+{
+  uint32_t frames = 0;
+  uint32_t packets = 0;
+  uint32_t bytes = 0;
+
+  void add(uint16_t packets, uint32_t bytes) {
+    frames++;
+    this->packets += packets;
+    this->bytes += bytes;
+  }
+
+  void reset() {
+    *this = OutputStats();
+  }
+
+  void serialize(JsonObject& data) const {
+    data["frames"] = frames;
+    data["packets"] = packets;
+    data["bytes"] = bytes;
+  }
+
+  void serialize(JsonWriter& writer) const {
+    writer.beginObject();
+    writer.member("frames", frames);
+    writer.member("packets", packets);
+    writer.member("bytes", bytes);
+    writer.endObject();
+  }
+
+  // size of the JSON buffer for serialize(JsonObject&)
+  static constexpr size_t jsonBufferSize() {
+    return JSON_OBJECT_SIZE(3);
+  }
+};
+
+// Counters of the frames and commands of a LedEffect, see LedEffect::stats()
+//
+// Durations are in microseconds, the render durations and outputs of the effects are by index of the effect.
+struct Stats
+{
+  uint32_t frames = 0;         // frames rendered and shown
+  uint32_t skippedFrames = 0;  // static frames neither rendered nor shown
+  uint32_t lateFrames = 0;     // frames finished after the deadline of the next frame, when not blocking
+  uint32_t droppedFrames = 0;  // deadlines missed entirely, when not blocking
+  uint32_t ingestedFrames = 0; // frames received and shown instead of the effect, see LedEffect::ingest()
+  uint16_t fps = 0;            // frames rendered or skipped in the last second, against LedEffect::fps
+  DurationStats render;        // whole render, both effects and the blend during a transition
+  DurationStats show;
+  DurationStats deserialize;   // parsing and applying a JSON or binary command
+  DurationStats queue;         // parsing and queuing a command, see LedEffect::queue()
+  DurationStats serialize;     // streaming the state
+  uint32_t deserializeBytes = 0;
+  uint32_t serializeBytes = 0;
+  DurationStats* effects = 0;  // render of each effect
+  OutputStats* outputs = 0;    // output of the frames of each effect, for sinks that output over a network
+  uint8_t effectCount = 0;
+
+  // reset every counter, keeping the effects
+  void reset() {
+    DurationStats* effects = this->effects;
+    OutputStats* outputs = this->outputs;
+    uint8_t effectCount = this->effectCount;
+    *this = Stats();
+    this->effects = effects;
+    this->outputs = outputs;
+    this->effectCount = effectCount;
+    for (uint8_t i = 0; i < effectCount; i++) {
+      effects[i].reset();
+      outputs[i].reset();
+    }
+  }
+};
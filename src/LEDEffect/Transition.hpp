@@ -0,0 +1,136 @@
+#pragma once
+
+#include <FastLED.h>
+
+#include "ColorKernels.hpp"
+#include "Configuration.hpp"
+#include "Effects/BaseEffect.hpp"
+
+// Crossfade from an outgoing effect to an incoming one
+//
+// Both effects render into buffers of their own, blended into the leds. The outgoing effect is frozen on its last
+// frame when it cannot render anymore or when rendering both effects would not fit in the frame budget.
+class Transition
+{
+public:
+  ~Transition() {
+    free(_outgoingLeds);
+  }
+
+  bool active() const {
+    return _active;
+  }
+
+  // start fading from the frame in leds to incoming over duration ms, return false if there is not enough memory
+  //
+  // Both effects render into buffers of the transition until it finishes or is cancelled. The outgoing effect keeps
+  // rendering if live, it is 0 if it was destroyed, and outgoingMicros is its last render time.
+  bool start(BaseEffect* outgoing, bool live, BaseEffect* incoming, CRGB* leds, uint16_t size, uint16_t duration,
+    uint32_t outgoingMicros) {
+    cancel();
+
+    if (size > _capacity) {
+      free(_outgoingLeds);
+      _outgoingLeds = (CRGB*)malloc(2 * size * sizeof(CRGB));
+      _incomingLeds = _outgoingLeds + size;
+      _capacity = _outgoingLeds ? size : 0;
+      if (!_outgoingLeds) {
+        LEDEFFECT_DEBUG_PRINTLN(F("Transition: Out of memory"));
+        return false;
+      }
+    }
+
+    _outgoing = outgoing;
+    _frozen = !live || !outgoing;
+    _incoming = incoming;
+    _leds = leds;
+    _size = size;
+    _duration = duration;
+    _start = millis();
+    _outgoingMicros = outgoingMicros;
+    _blendMicros = 0;
+    _active = true;
+
+    memcpy(_outgoingLeds, leds, size * sizeof(CRGB));
+    memcpy(_incomingLeds, leds, size * sizeof(CRGB));
+    if (_outgoing)
+      _outgoing->begin(_outgoingLeds, size);
+    _incoming->begin(_incomingLeds, size);
+    return true;
+  }
+
+  // render a frame of both effects and blend it into the leds, the outgoing effect only if the frame takes at most
+  // budgetMicros, finishing the transition after its last frame
+  void render(const FrameContext& frame, uint32_t budgetMicros) {
+    uint32_t start = micros();
+    _incoming->loop(frame);
+    _incomingMicros = micros() - start;
+
+    if (!_frozen) {
+      if (_outgoingMicros + _incomingMicros + _blendMicros > budgetMicros) {
+        LEDEFFECT_DEBUG_PRINTLN(F("Transition: Over budget, freezing the outgoing effect"));
+        _frozen = true;
+      } else {
+        start = micros();
+        _outgoing->loop(frame);
+        _outgoingMicros = micros() - start;
+      }
+    }
+
+    start = micros();
+    uint32_t elapsed = millis() - _start;
+    uint8_t progress = elapsed >= _duration ? 255 : elapsed * 255 / _duration;
+    memcpy(_leds, _incomingLeds, _size * sizeof(CRGB));
+    ColorKernels::blend(_leds, _outgoingLeds, _size, 255 - progress);
+    _blendMicros = micros() - start;
+
+    if (progress == 255)
+      finish();
+  }
+
+  // end the transition with the frame of the incoming effect
+  void finish() {
+    if (!_active)
+      return;
+
+    memcpy(_leds, _incomingLeds, _size * sizeof(CRGB));
+    cancel();
+  }
+
+  // end the transition keeping the blended frame in the leds, before either effect is destroyed or switched from
+  void cancel() {
+    if (!_active)
+      return;
+
+    _incoming->begin(_leds, _size);
+    if (_outgoing)
+      _outgoing->begin(_leds, _size);
+    _active = false;
+  }
+
+  // render time of the incoming effect in the last frame
+  uint32_t incomingMicros() const {
+    return _incomingMicros;
+  }
+
+  // whether the outgoing effect stopped rendering for lack of budget or because it could not render
+  bool frozen() const {
+    return _frozen;
+  }
+
+private:
+  CRGB* _outgoingLeds = 0;  // both buffers in one allocation
+  CRGB* _incomingLeds = 0;
+  uint16_t _capacity = 0;
+  BaseEffect* _outgoing = 0;
+  BaseEffect* _incoming = 0;
+  CRGB* _leds = 0;
+  uint16_t _size = 0;
+  uint16_t _duration = 0;
+  uint32_t _start = 0;
+  uint32_t _outgoingMicros = 0;
+  uint32_t _incomingMicros = 0;
+  uint32_t _blendMicros = 0;
+  bool _frozen = false;
+  bool _active = false;
+};